@@ -0,0 +1,390 @@
+// gh_bench: benchmark de regressão do NoteManager com charts sintéticos.
+//
+// Uso: gh_bench [--seed N] [--density notas/s] [--chords taxa] [--length segundos]
+//               [--render-every N] [--out arquivo.json]
+//
+// Sem parâmetros de chart roda a bateria padrão (de ~1 mil a ~1 milhão de notas).
+// Para cada chart gerado, roda sempre os mesmos roteiros:
+//   load_text  loadSong do chart em texto (parse + compilação do .ghc)
+//   load_ghc   loadSong do .ghc já compilado (mmap)
+//   play       a música inteira a 60 FPS: update, um toque por nota (com erro de
+//              tempo sorteado) e render pelo backend headless (bitmap em memória)
+// Depois, render_scaling mede o custo de um render com ~10, ~100 e ~1000 notas na
+// tela, em lote (NoteManager::render) e com uma elipse por nota.
+// O resultado sai em JSON (ns/nota, ns/frame, alocações, pico de memória e o hash
+// do último frame desenhado), para comparar builds diferentes.
+#include "note_manager.h"
+#include "render_backend.h"
+#include "render_list.h"
+#include <allegro5/allegro5.h>
+#include <allegro5/allegro_primitives.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// --- Contagem de alocações (todas as chamadas de operator new do processo) ---
+static std::atomic<size_t> allocation_count(0);
+static std::atomic<size_t> allocated_bytes(0);
+
+void* operator new(size_t size) {
+    allocation_count++;
+    allocated_bytes += size;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+struct AllocationMark {
+    size_t count = allocation_count;
+    size_t bytes = allocated_bytes;
+};
+
+// Pico de memória residente do processo, em KB
+static long peakRssKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return -1;
+    return static_cast<long>(counters.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+    return usage.ru_maxrss;
+#endif
+}
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsedNs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+static const float DELTA_TIME = 1.0f / 60.0f;
+static const float FIRST_NOTE_TIME = 1.0f;
+static const float PRESS_JITTER = 0.030f; // Desvio padrão do erro de tempo dos toques (segundos)
+static const int SCREEN_WIDTH = 800;
+static const int SCREEN_HEIGHT = 600;
+
+struct ChartSpec {
+    std::string name;
+    unsigned seed = 1;
+    float density = 8.0f;    // Notas por segundo (contando as de acordes)
+    float chord_rate = 0.1f; // Fração dos instantes que viram acordes de duas notas
+    float length = 120.0f;   // Duração da música, em segundos
+    int render_every = 1;    // Renderiza 1 a cada N frames
+};
+
+struct GeneratedNote {
+    double time;
+    int key_code;
+};
+
+// Gera um chart aleatório (mas reproduzível pela seed) e grava em texto
+static std::vector<GeneratedNote> generateChart(const ChartSpec& spec, const std::string& path) {
+    const int keys[NUM_TRACKS] = {ALLEGRO_KEY_A, ALLEGRO_KEY_S, ALLEGRO_KEY_D, ALLEGRO_KEY_F, ALLEGRO_KEY_G};
+    std::mt19937 rng(spec.seed);
+    std::uniform_int_distribution<int> lane(0, NUM_TRACKS - 1);
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+    // Cada instante tem 1 nota, ou 2 com probabilidade chord_rate
+    const double step = (1.0 + spec.chord_rate) / spec.density;
+    std::vector<GeneratedNote> notes;
+    notes.reserve(static_cast<size_t>(spec.density * spec.length) + 2);
+
+    std::ofstream file(path);
+    file << "# chart sintético: seed " << spec.seed << ", " << spec.density << " notas/s, "
+         << spec.chord_rate << " acordes, " << spec.length << " s\n";
+    // Cada tempo é calculado a partir do índice, sem acumular erro de arredondamento
+    for (size_t k = 0; ; ++k) {
+        const double time = FIRST_NOTE_TIME + k * step;
+        if (time >= FIRST_NOTE_TIME + spec.length) break;
+        int first = lane(rng);
+        notes.push_back({time, keys[first]});
+        if (chance(rng) < spec.chord_rate) {
+            int second = (first + 1 + lane(rng) % (NUM_TRACKS - 1)) % NUM_TRACKS;
+            notes.push_back({time, keys[second]});
+        }
+    }
+    // 9 algarismos significativos bastam para o float lido pelo parser sair igual
+    file << std::setprecision(9);
+    for (const GeneratedNote& note : notes) {
+        file << note.time << " " << note.key_code << "\n";
+    }
+    return notes;
+}
+
+static void removeChart(const std::string& path) {
+    std::string compiled_path = path.substr(0, path.rfind('.')) + ".ghc";
+    std::remove(path.c_str());
+    std::remove(compiled_path.c_str());
+}
+
+static void writeAllocations(FILE* out, const AllocationMark& mark) {
+    std::fprintf(out, "\"allocations\": %zu, \"allocated_bytes\": %zu",
+                 allocation_count - mark.count, allocated_bytes - mark.bytes);
+}
+
+static void runChart(const ChartSpec& spec, HeadlessRenderBackend& backend, FILE* out, bool first) {
+    std::string path = "gh_bench_" + spec.name + ".txt";
+    removeChart(path);
+    std::vector<GeneratedNote> notes = generateChart(spec, path);
+    const double note_count = static_cast<double>(notes.size());
+
+    std::fprintf(out, "%s\n    {\"name\": \"%s\", \"seed\": %u, \"density\": %g, \"chord_rate\": %g, "
+                 "\"length\": %g, \"notes\": %zu,\n",
+                 first ? "" : ",", spec.name.c_str(), spec.seed, spec.density, spec.chord_rate,
+                 spec.length, notes.size());
+
+    // Carga do texto: parse e gravação do .ghc
+    {
+        NoteManager manager;
+        AllocationMark mark;
+        Clock::time_point start = Clock::now();
+        manager.loadSong(path);
+        Clock::time_point end = Clock::now();
+        std::fprintf(out, "     \"load_text\": {\"ns_per_note\": %.2f, ", elapsedNs(start, end) / note_count);
+        writeAllocations(out, mark);
+        std::fprintf(out, "},\n");
+    }
+
+    // Roteiro de jogo: carrega como o jogo faz (o texto, com o .ghc já em dia) e toca a música inteira
+    NoteManager manager;
+    AllocationMark load_mark;
+    Clock::time_point start = Clock::now();
+    manager.loadSong(path);
+    Clock::time_point end = Clock::now();
+    std::fprintf(out, "     \"load_cached\": {\"ns_per_note\": %.2f, ", elapsedNs(start, end) / note_count);
+    writeAllocations(out, load_mark);
+    std::fprintf(out, "},\n");
+
+    std::mt19937 rng(spec.seed ^ 0x9e3779b9u);
+    std::normal_distribution<float> jitter(0.0f, PRESS_JITTER);
+    std::vector<double> press_times(notes.size());
+    std::vector<size_t> press_order(notes.size());
+    for (size_t i = 0; i < notes.size(); ++i) {
+        press_times[i] = notes[i].time + jitter(rng);
+        press_order[i] = i;
+    }
+    // Com o erro de tempo, os toques não saem necessariamente na ordem das notas
+    std::sort(press_order.begin(), press_order.end(),
+              [&press_times](size_t a, size_t b) { return press_times[a] < press_times[b]; });
+
+    const ALLEGRO_COLOR black = al_map_rgb(0, 0, 0);
+    RenderList frame;
+
+    double update_ns = 0;
+    double hit_ns = 0;
+    double render_ns = 0;
+    long frames = 0;
+    long rendered_frames = 0;
+    size_t presses = 0;
+    size_t next_press = 0;
+    Judgement judgement;
+
+    AllocationMark play_mark;
+    float song_position = 0.0f;
+    while (!manager.isSongFinished()) {
+        song_position = frames * DELTA_TIME;
+
+        Clock::time_point t0 = Clock::now();
+        manager.update(song_position);
+        Clock::time_point t1 = Clock::now();
+        // Toques cujo instante já passou neste frame (como os eventos de teclado do jogo)
+        while (next_press < notes.size() && press_times[press_order[next_press]] <= song_position) {
+            size_t note = press_order[next_press];
+            manager.checkHit(notes[note].key_code, press_times[note], judgement);
+            next_press++;
+            presses++;
+        }
+        Clock::time_point t2 = Clock::now();
+        update_ns += elapsedNs(t0, t1);
+        hit_ns += elapsedNs(t1, t2);
+
+        if (frames % spec.render_every == 0) {
+            Clock::time_point t3 = Clock::now();
+            frame.clear();
+            frame.clearTo(black);
+            manager.render(song_position, frame);
+            backend.present(frame);
+            render_ns += elapsedNs(t3, Clock::now());
+            rendered_frames++;
+        }
+        frames++;
+    }
+
+    int missed = manager.getTierCount(JudgementTier::MISS);
+    std::fprintf(out, "     \"play\": {\"frames\": %ld, \"rendered_frames\": %ld, \"presses\": %zu, "
+                 "\"hits\": %zu, \"misses\": %d,\n",
+                 frames, rendered_frames, presses, notes.size() - missed, missed);
+    double frame_ns = (update_ns + hit_ns) / frames + (rendered_frames ? render_ns / rendered_frames : 0);
+    std::fprintf(out, "              \"ns_per_frame\": %.1f, \"ns_per_note\": %.2f, "
+                 "\"update_ns_per_frame\": %.1f, \"check_hit_ns_per_press\": %.1f, "
+                 "\"render_ns_per_frame\": %.1f,\n              ",
+                 frame_ns, (update_ns + hit_ns + render_ns) / note_count, update_ns / frames,
+                 presses ? hit_ns / presses : 0.0, rendered_frames ? render_ns / rendered_frames : 0.0);
+    writeAllocations(out, play_mark);
+    std::fprintf(out, "},\n");
+    std::fprintf(out, "     \"frame_hash\": \"%08x\", \"peak_rss_kb\": %ld}", backend.frameHash(), peakRssKb());
+    std::fflush(out);
+
+    removeChart(path);
+}
+
+// Render com N notas na tela: em lote, pelo NoteManager, contra uma elipse por nota
+static void runRenderScaling(HeadlessRenderBackend& backend, FILE* out) {
+    const int targets[] = {10, 100, 1000};
+    const int REPEATS = 200;
+    const float ON_SCREEN_SECONDS = 1.85f; // Da entrada no topo até passar da janela de acerto
+    const float SONG_POSITION = 5.0f;
+
+    RenderList frame;
+    std::fprintf(out, ",\n  \"render_scaling\": [");
+    for (size_t t = 0; t < sizeof(targets) / sizeof(targets[0]); ++t) {
+        ChartSpec spec;
+        spec.name = "render_" + std::to_string(targets[t]);
+        spec.density = targets[t] / ON_SCREEN_SECONDS;
+        spec.chord_rate = 0.0f;
+        spec.length = 10.0f;
+        std::string path = "gh_bench_" + spec.name + ".txt";
+        generateChart(spec, path);
+
+        NoteManager manager;
+        manager.loadSong(path);
+        removeChart(path);
+        manager.update(SONG_POSITION);
+        const int visible = manager.getActiveNotesCount();
+
+        Clock::time_point start = Clock::now();
+        for (int r = 0; r < REPEATS; ++r) {
+            frame.clear();
+            manager.render(SONG_POSITION, frame);
+            backend.present(frame);
+        }
+        const double batched_ns = elapsedNs(start, Clock::now()) / REPEATS;
+
+        start = Clock::now();
+        for (int r = 0; r < REPEATS; ++r) {
+            frame.clear();
+            for (int i = 0; i < visible; ++i) {
+                float x = 240.0f + (i % NUM_TRACKS) * 80.0f;
+                float y = static_cast<float>(i) * SCREEN_HEIGHT / visible;
+                frame.filledEllipse(x, y, 35, 15, al_map_rgb(255, 0, 0));
+            }
+            backend.present(frame);
+        }
+        const double per_note_ns = elapsedNs(start, Clock::now()) / REPEATS;
+
+        std::fprintf(out, "%s\n    {\"target\": %d, \"visible_notes\": %d, \"batched_ns_per_frame\": %.1f, "
+                     "\"per_note_ns_per_frame\": %.1f}",
+                     t == 0 ? "" : ",", targets[t], visible, batched_ns, per_note_ns);
+    }
+    std::fprintf(out, "\n  ]");
+}
+
+static void printUsage() {
+    std::fprintf(stderr, "Uso: gh_bench [--seed N] [--density notas/s] [--chords taxa] [--length segundos]\n"
+                         "                [--render-every N] [--out arquivo.json]\n");
+}
+
+int main(int argc, char** argv) {
+    ChartSpec custom;
+    custom.name = "custom";
+    bool has_custom = false;
+    std::string out_path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage();
+            return 2;
+        }
+        const char* value = argv[++i];
+        if (arg == "--seed") {
+            custom.seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--density") {
+            custom.density = std::strtof(value, nullptr);
+        } else if (arg == "--chords") {
+            custom.chord_rate = std::strtof(value, nullptr);
+        } else if (arg == "--length") {
+            custom.length = std::strtof(value, nullptr);
+        } else if (arg == "--render-every") {
+            custom.render_every = std::atoi(value);
+        } else if (arg == "--out") {
+            out_path = value;
+            continue;
+        } else {
+            printUsage();
+            return 2;
+        }
+        has_custom = true;
+    }
+    if (custom.density <= 0 || custom.length <= 0 || custom.render_every < 1 ||
+        custom.chord_rate < 0 || custom.chord_rate > 1) {
+        printUsage();
+        return 2;
+    }
+
+    // O loadSong escreve mensagens no std::cout; a saída padrão fica só para o JSON
+    std::cout.rdbuf(nullptr);
+
+    std::vector<ChartSpec> specs;
+    if (has_custom) {
+        specs.push_back(custom);
+    } else {
+        // Bateria padrão: charts em ordem crescente de tamanho (o pico de memória é do processo)
+        specs.push_back({"song", 1, 8.0f, 0.10f, 180.0f, 1});
+        specs.push_back({"dense", 2, 60.0f, 0.30f, 600.0f, 1});
+        specs.push_back({"marathon", 3, 12.0f, 0.15f, 43200.0f, 30});
+        specs.push_back({"million", 4, 200.0f, 0.40f, 5000.0f, 30});
+    }
+
+    if (!al_init() || !al_init_primitives_addon()) {
+        std::fprintf(stderr, "Erro ao inicializar a Allegro\n");
+        return 1;
+    }
+    // Renderiza num bitmap em memória: não precisa de display nem de GPU
+    HeadlessRenderBackend backend(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (!backend.isValid()) {
+        std::fprintf(stderr, "Erro ao criar o bitmap de destino\n");
+        return 1;
+    }
+
+    FILE* out = stdout;
+    if (!out_path.empty()) {
+        out = std::fopen(out_path.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "Erro ao abrir %s\n", out_path.c_str());
+            return 1;
+        }
+    }
+
+    std::fprintf(out, "{\n  \"benchmark\": \"gh_bench\",\n  \"runs\": [");
+    for (size_t i = 0; i < specs.size(); ++i) {
+        runChart(specs[i], backend, out, i == 0);
+    }
+    std::fprintf(out, "\n  ]");
+    runRenderScaling(backend, out);
+    std::fprintf(out, "\n}\n");
+
+    if (out != stdout) std::fclose(out);
+    return 0;
+}
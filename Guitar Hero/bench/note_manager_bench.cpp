@@ -0,0 +1,196 @@
+// Benchmark do NoteManager: mede o custo médio de update() por frame
+// para charts de tamanhos diferentes, com a mesma densidade de notas.
+// O custo por frame deve ficar constante, independente do tamanho do chart.
+// A segunda tabela usa charts muito densos para medir o custo por nota visível,
+// a terceira mede o custo de julgar um toque (checkHit) em charts grandes
+// a quarta compara o tempo de carga do chart em texto, em .ghc e do texto com o .ghc em dia
+// e a quinta compara o parser de texto com a leitura via iostream.
+#include "note_manager.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const float NOTES_PER_SECOND = 8.0f;
+static const int FRAMES = 60 * 60; // 1 minuto de jogo a 60 FPS
+static const float DELTA_TIME = 1.0f / 60.0f;
+
+static std::string writeChart(int note_count, float notes_per_second) {
+    std::string path = "bench_chart_" + std::to_string(note_count) + ".txt";
+    std::ofstream file(path);
+    const int keys[] = {ALLEGRO_KEY_A, ALLEGRO_KEY_S, ALLEGRO_KEY_D, ALLEGRO_KEY_F, ALLEGRO_KEY_G};
+    // Tempos em double com 9 algarismos: com a precisão padrão (6), os charts longos
+    // arredondavam para o segundo inteiro e várias notas caíam no mesmo tempo
+    file << std::setprecision(9);
+    for (int i = 0; i < note_count; ++i) {
+        file << (1.0 + i / static_cast<double>(notes_per_second)) << " " << keys[i % 5] << "\n";
+    }
+    return path;
+}
+
+// Apaga o chart em texto e o .ghc que o loadSong gera ao lado dele
+static void removeChart(const std::string& path) {
+    std::string compiled_path = path.substr(0, path.rfind('.')) + ".ghc";
+    std::remove(path.c_str());
+    std::remove(compiled_path.c_str());
+}
+
+static double framesCost(NoteManager& manager, int frames) {
+    float song_position = 0.0f;
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        song_position += DELTA_TIME;
+        manager.update(song_position);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+int main() {
+    const int sizes[] = {500, 5000, 50000, 500000, 1000000};
+
+    std::printf("%10s %14s\n", "notas", "ns/frame");
+    for (int note_count : sizes) {
+        std::string path = writeChart(note_count, NOTES_PER_SECOND);
+        NoteManager manager;
+        manager.loadSong(path);
+        removeChart(path);
+
+        double ns = framesCost(manager, FRAMES);
+        std::printf("%10d %14.1f\n", note_count, ns / FRAMES);
+    }
+
+    // Vazão do update: charts densos, medindo só os frames com a tela cheia
+    const float densities[] = {500.0f, 2000.0f, 8000.0f};
+    const int DENSE_FRAMES = 600;
+
+    std::printf("\n%10s %14s %14s %14s\n", "notas/s", "na tela", "ns/frame", "ns/nota");
+    for (float density : densities) {
+        int note_count = static_cast<int>(density * 30);
+        std::string path = writeChart(note_count, density);
+        NoteManager manager;
+        manager.loadSong(path);
+        removeChart(path);
+
+        // Aquece até a tela encher (a primeira nota é em t = 1s)
+        framesCost(manager, 180);
+        int visible = manager.getActiveNotesCount();
+
+        float song_position = 180 * DELTA_TIME;
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < DENSE_FRAMES; ++frame) {
+            song_position += DELTA_TIME;
+            manager.update(song_position);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / DENSE_FRAMES;
+        std::printf("%10.0f %14d %14.1f %14.2f\n", density, visible, ns, ns / visible);
+    }
+
+    // Julgamento: toques no meio do chart, sem update() antes (pior caso da busca)
+    const int judge_sizes[] = {1000, 100000, 1000000};
+    const int keys[] = {ALLEGRO_KEY_A, ALLEGRO_KEY_S, ALLEGRO_KEY_D, ALLEGRO_KEY_F, ALLEGRO_KEY_G};
+
+    std::printf("\n%10s %14s %14s\n", "notas", "acertos", "ns/toque");
+    for (int note_count : judge_sizes) {
+        std::string path = writeChart(note_count, NOTES_PER_SECOND);
+        NoteManager manager;
+        manager.loadSong(path);
+        removeChart(path);
+
+        int presses = 0;
+        int hits = 0;
+        Judgement judgement;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = note_count / 2; i < note_count && presses < 500; ++i, ++presses) {
+            double press_time = 1.0 + i / NOTES_PER_SECOND + 0.02;
+            if (manager.checkHit(keys[i % 5], press_time, judgement)) hits++;
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        std::printf("%10d %14d %14.1f\n", note_count, hits, ns / presses);
+    }
+
+    // Carga: texto (parse + montagem do .ghc) contra mmap do .ghc pronto
+    const int load_sizes[] = {500, 50000, 1000000};
+
+    std::printf("\n%10s %14s %14s %14s %18s\n", "notas", "texto (us)", "mmap (us)", "loadSong (us)",
+                "loadSong .txt (us)");
+    for (int note_count : load_sizes) {
+        std::string path = writeChart(note_count, NOTES_PER_SECOND);
+        std::string compiled_path = path.substr(0, path.rfind('.')) + ".ghc";
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<uint8_t> bytes;
+        Chart::compileText(path, bytes);
+        auto end = std::chrono::steady_clock::now();
+        double text_us = std::chrono::duration<double, std::micro>(end - start).count();
+        Chart::write(compiled_path, bytes);
+
+        Chart chart;
+        start = std::chrono::steady_clock::now();
+        chart.open(compiled_path);
+        end = std::chrono::steady_clock::now();
+        double mmap_us = std::chrono::duration<double, std::micro>(end - start).count();
+
+        NoteManager manager;
+        start = std::chrono::steady_clock::now();
+        manager.loadSong(compiled_path);
+        end = std::chrono::steady_clock::now();
+        double load_us = std::chrono::duration<double, std::micro>(end - start).count();
+
+        // Como o jogo carrega: pelo caminho do texto, com o .ghc compilado ao lado
+        start = std::chrono::steady_clock::now();
+        manager.loadSong(path);
+        end = std::chrono::steady_clock::now();
+        double cached_us = std::chrono::duration<double, std::micro>(end - start).count();
+
+        removeChart(path);
+        std::printf("%10d %14.1f %14.1f %14.1f %18.1f\n", note_count, text_us, mmap_us, load_us, cached_us);
+    }
+
+    // Parse do texto em memória: iostream (como era o loadSong) contra parseChartText
+    std::string text = "# chart de benchmark\n\n";
+    for (int i = 0; i < 1000000; ++i) {
+        text += std::to_string(1.0f + i / NOTES_PER_SECOND) + " " + std::to_string("asdfg"[i % 5]) + "\n";
+        if (i % 100 == 0) text += "# secao\n\n";
+    }
+    double megabytes = text.size() / (1024.0 * 1024.0);
+
+    std::vector<float> times;
+    std::vector<uint8_t> tracks;
+    auto start = std::chrono::steady_clock::now();
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        float time;
+        int key_code;
+        if (fields >> time >> key_code) {
+            times.push_back(time);
+            tracks.push_back(static_cast<uint8_t>(chart_code_to_track(key_code)));
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double iostream_s = std::chrono::duration<double>(end - start).count();
+    size_t iostream_notes = times.size();
+
+    times.clear();
+    tracks.clear();
+    std::vector<ChartDiagnostic> diagnostics;
+    start = std::chrono::steady_clock::now();
+    parseChartText(text.data(), text.size(), times, tracks, diagnostics);
+    end = std::chrono::steady_clock::now();
+    double parser_s = std::chrono::duration<double>(end - start).count();
+
+    std::printf("\n%10s %14s %14s\n", "parser", "notas", "MB/s");
+    std::printf("%10s %14zu %14.1f\n", "iostream", iostream_notes, megabytes / iostream_s);
+    std::printf("%10s %14zu %14.1f\n", "from_chars", times.size(), megabytes / parser_s);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <vector>
+
+// Média dos valores depois de descartar a fração trim dos menores e dos maiores
+double trimmedMean(std::vector<double> values, double trim);
+double median(std::vector<double> values);
+
+// Calibração de latência em duas fases, medidas em relação a batidas regulares:
+//   AUDIO  um metrônomo toca e o jogador toca junto com o clique
+//   VIDEO  sem som, um alvo desce até a linha e o jogador toca quando ele cruza
+// O offset de cada toque é (instante do toque - instante da batida). Os primeiros
+// toques de cada fase são descartados (o jogador ainda está pegando o ritmo) e o
+// resultado é a média aparada dos outros, robusta a toques errados.
+class Calibration {
+public:
+    enum class Phase {
+        AUDIO,
+        VIDEO,
+        DONE
+    };
+
+    static const int WARMUP_TAPS = 4;
+    static const int MEASURED_TAPS = 16;
+
+    Calibration();
+
+    // Começa pela fase de áudio; now e os toques usam a base de al_get_time
+    void start(double now);
+    // Chamado a cada tick: devolve true quando o clique do metrônomo deve tocar
+    bool updateClick(double now);
+    void tap(double time);
+
+    Phase phase() const { return current_phase; }
+    double beatInterval() const;
+    // Tempo até a próxima batida da fase atual (para desenhar o alvo da fase de vídeo)
+    double timeToNextBeat(double now) const;
+    int measuredTaps() const;
+
+    // Resultados (segundos; positivo = o jogador toca atrasado)
+    double audioOffset() const { return audio_offset; }
+    double videoOffset() const { return video_offset; }
+    double audioMedian() const { return audio_median; }
+    double videoMedian() const { return video_median; }
+
+private:
+    Phase current_phase;
+    double phase_start;             // Instante da batida 0 da fase atual
+    int next_click;                 // Próxima batida do metrônomo a tocar
+    std::vector<double> beat_times; // Instantes em que os últimos cliques realmente tocaram
+    std::vector<double> offsets;    // Offsets dos toques da fase atual
+    int taps;
+
+    double audio_offset;
+    double video_offset;
+    double audio_median;
+    double video_median;
+
+    double nearestBeat(double time) const;
+    void startPhase(Phase phase, double now);
+};
+
+#endif // CALIBRATION_H
@@ -0,0 +1,54 @@
+#ifndef CHART_CACHE_H
+#define CHART_CACHE_H
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include "chart_file.h"
+
+// Cache LRU de charts já carregados, para que "Jogar Novamente" e partidas
+// repetidas não abram e processem o arquivo de novo. Cada entrada é identificada
+// pelo caminho e só vale enquanto a data de modificação e o tamanho do arquivo
+// forem os mesmos. Os charts são imutáveis e compartilhados com quem os usa.
+class ChartCache {
+public:
+    explicit ChartCache(size_t capacity_bytes);
+
+    // Devolve o chart do cache ou carrega do disco (nullptr se falhar)
+    std::shared_ptr<const Chart> load(const std::string& path);
+
+    void setCapacity(size_t capacity_bytes);
+    void clear();
+
+    size_t capacity() const { return capacity_bytes; }
+    size_t usedBytes() const { return used_bytes; }
+    size_t entryCount() const { return entries.size(); }
+    size_t hits() const { return hit_count; }
+    size_t misses() const { return miss_count; }
+
+private:
+    struct Entry {
+        std::string path;
+        int64_t mtime;
+        uint64_t file_size;
+        std::shared_ptr<const Chart> chart;
+        size_t bytes;
+    };
+
+    // Mais recente no começo da lista
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+    size_t capacity_bytes;
+    size_t used_bytes;
+    size_t hit_count;
+    size_t miss_count;
+
+    void erase(std::list<Entry>::iterator it);
+    void evict();
+};
+
+#endif // CHART_CACHE_H
@@ -0,0 +1,143 @@
+#ifndef CHART_FILE_H
+#define CHART_FILE_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+const int NUM_TRACKS = 5;
+
+// Mapeamento de teclas do teclado (ALLEGRO_KEY_*) para trilhas (0 a 4)
+int map_key_to_track(int keycode);
+// Mapeamento do código de tecla escrito no chart (ASCII ou ALLEGRO_KEY_*) para trilhas
+int chart_code_to_track(int code);
+
+// Erro encontrado no parse de um chart em texto
+struct ChartDiagnostic {
+    int line;
+    std::string message;
+};
+
+// Parse de um chart em texto: uma nota por linha, "tempo código_da_tecla".
+// Aceita linhas vazias e comentários começando com '#'. Linhas com erro são
+// puladas e registradas em diagnostics. Retorna false se houve algum erro.
+bool parseChartText(const char* text, size_t length,
+                    std::vector<float>& times, std::vector<uint8_t>& tracks,
+                    std::vector<ChartDiagnostic>& diagnostics);
+
+// --- Formato binário de chart (.ghc) ---
+// Tudo em little-endian. Depois do cabeçalho vêm três blocos, na ordem:
+//   float    times[note_count]   tempos das notas, em ordem crescente
+//   uint32_t lanes[note_count]   índices das notas agrupados por trilha (trilha 0, 1, ...)
+//   uint8_t  tracks[note_count]  trilha de cada nota
+// O checksum (FNV-1a de 32 bits) cobre todos os bytes depois do cabeçalho.
+// source_hash, source_size e source_mtime identificam o chart em texto que gerou o
+// arquivo (zero se desconhecido) e dizem se o .ghc precisa ser recompilado: tamanho
+// e data iguais bastam; se mudaram, o texto é lido e o hash decide.
+// GHC_FLAG_VALIDATED só é gravado pelo ghchartc, junto com audio_stamp (tamanho e data
+// do .ogg usado para conferir o chart): um .ghc compilado pelo jogo não tem a marca e
+// o ghchartc confere o chart de novo.
+const uint32_t GHC_MAGIC = 0x00434847; // "GHC\0"
+const uint32_t GHC_VERSION = 3; // 3: cabeçalho de 96 bytes com tamanho e data do texto
+const uint32_t GHC_FLAG_VALIDATED = 1 << 0; // Conferido e normalizado pelo ghchartc
+
+struct ChartFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t note_count;
+    uint32_t lane_count[NUM_TRACKS];
+    uint32_t checksum;
+    uint64_t source_hash;
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint64_t audio_stamp;
+    uint32_t flags;
+    uint32_t reserved[5];
+};
+
+// Origem de um .ghc (o chart em texto), gravada no cabeçalho
+struct ChartSource {
+    uint64_t hash = 0;  // chartSourceHash do texto
+    uint64_t size = 0;  // Tamanho do texto em bytes
+    int64_t mtime = 0;  // Data de modificação do texto, na unidade do sistema de arquivos
+    uint64_t audio_stamp = 0; // Só o ghchartc preenche
+    uint32_t flags = 0;       // Combinação de GHC_FLAG_*
+};
+
+// Dados imutáveis de um chart (tempos, trilhas e filas por trilha) no formato .ghc,
+// mapeados direto do disco (mmap) ou guardados em memória. Os ponteiros devolvidos
+// apontam para dentro do próprio arquivo, sem cópia. Depois de carregado, o chart é
+// compartilhado como shared_ptr<const Chart>: vários NoteManagers (jogadores, bots)
+// podem ler o mesmo chart, cada um com o seu próprio JudgementState.
+class Chart {
+public:
+    Chart();
+    ~Chart();
+    Chart(const Chart&) = delete;
+    Chart& operator=(const Chart&) = delete;
+
+    bool open(const std::string& path);
+    bool adopt(std::vector<uint8_t>&& bytes);
+    void close();
+
+    bool isOpen() const { return data != nullptr; }
+    size_t noteCount() const { return note_count; }
+    size_t byteSize() const { return size; }
+    const float* times() const { return note_times; }
+    const uint8_t* tracks() const { return note_tracks; }
+    const uint32_t* laneNotes(int track) const { return lane_notes[track]; }
+    size_t laneSize(int track) const { return lane_size[track]; }
+
+    bool verifyChecksum() const;
+    ChartFileHeader header() const;
+
+    // Monta os bytes de um .ghc a partir das notas (ordena por tempo)
+    static std::vector<uint8_t> build(const std::vector<float>& times, const std::vector<uint8_t>& tracks,
+                                      const ChartSource& source = ChartSource());
+    // Lê um chart em texto ("tempo tecla" por linha) e monta o .ghc correspondente
+    static bool compileText(const std::string& path, std::vector<uint8_t>& bytes);
+    // Grava num arquivo temporário e renomeia, para nunca deixar um .ghc pela metade
+    static bool write(const std::string& path, const std::vector<uint8_t>& bytes);
+
+private:
+    const uint8_t* data;
+    size_t size;
+    std::vector<uint8_t> owned; // Usado quando o chart não veio de um mmap
+
+#ifdef _WIN32
+    void* file_handle;
+    void* mapping_handle;
+#endif
+
+    size_t note_count;
+    const float* note_times;
+    const uint8_t* note_tracks;
+    const uint32_t* lane_notes[NUM_TRACKS];
+    size_t lane_size[NUM_TRACKS];
+
+    bool bind(const uint8_t* bytes, size_t length);
+};
+
+// Lê o arquivo inteiro (o parser trabalha direto no buffer)
+bool readChartText(const std::string& path, std::string& text);
+// Hash (FNV-1a de 64 bits) do conteúdo de um chart em texto. Para calcular aos
+// poucos, passe o resultado do pedaço anterior em hash.
+const uint64_t SOURCE_HASH_SEED = 14695981039346656037ull;
+uint64_t chartSourceHash(const char* text, size_t length, uint64_t hash = SOURCE_HASH_SEED);
+// Preenche tamanho e data de modificação do arquivo em path (o resto fica como está)
+bool chartSourceStamp(const std::string& path, ChartSource& source);
+
+// Garante que existe um .ghc atualizado para o chart em path (compilando o texto
+// se preciso) e devolve o caminho dele em compiled_path. Feito para charts longos
+// demais para a memória: o texto é lido em pedaços e nunca inteiro, e por isso as
+// notas precisam estar em ordem (o ghchartc normaliza charts fora de ordem).
+bool compileChart(const std::string& path, std::string& compiled_path);
+
+// Carrega um chart: arquivos .ghc são mapeados direto; arquivos de texto são
+// compilados para um .ghc ao lado deles (reaproveitado enquanto estiver atualizado).
+// Com o .ghc em dia, o texto nem é lido: só o cabeçalho é comparado com o arquivo.
+bool loadChart(const std::string& path, Chart& chart);
+
+#endif // CHART_FILE_H
@@ -0,0 +1,54 @@
+#ifndef CHART_STREAM_H
+#define CHART_STREAM_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <cstddef>
+#include <cstdint>
+#include "spsc_ring.h"
+
+struct StreamedNote {
+    float time;
+    uint8_t track;
+};
+
+// Lê um chart .ghc aos poucos, numa thread própria, para charts muito longos
+// rodarem com memória limitada. A thread lê do arquivo só as notas que estão até
+// lookahead segundos à frente da posição atual da música e as entrega por uma
+// fila SPSC de tamanho fixo. Quem consome (o NoteManager) chama setPlayhead a
+// cada update e retira as notas com pop.
+class ChartStream {
+public:
+    ChartStream(size_t ring_capacity, double lookahead_seconds);
+    ~ChartStream();
+    ChartStream(const ChartStream&) = delete;
+    ChartStream& operator=(const ChartStream&) = delete;
+
+    // Aceita .ghc ou texto (compilado para .ghc antes, aos poucos, sem carregar o texto inteiro)
+    bool open(const std::string& path);
+    // Volta para o começo do chart já aberto, sem conferir o texto de novo
+    bool rewind();
+    void close();
+
+    size_t noteCount() const { return note_count; }
+    void setPlayhead(double song_position);
+    bool pop(StreamedNote& note) { return ring.pop(note); }
+    // A leitura parou por erro: nenhuma nota além das já entregues vai chegar
+    bool failed() const { return read_failed.load(); }
+
+private:
+    SpscRing<StreamedNote> ring;
+    double lookahead;
+    std::atomic<double> playhead;
+    std::atomic<bool> stop_requested;
+    std::atomic<bool> read_failed;
+    std::thread reader;
+    size_t note_count;
+    std::string compiled_path;
+
+    bool start();
+    void readLoop(std::string compiled_path, size_t times_offset, size_t tracks_offset);
+};
+
+#endif // CHART_STREAM_H
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include <map>
 
 // Agora o FileHandler só lida com operações genéricas de arquivo.
 class FileHandler {
@@ -10,6 +11,13 @@ public:
     // Lista todos os arquivos em um diretório (implementação simplificada)
     static std::vector<std::string> listFiles(const std::string& directoryPath);
     static bool saveScore(const std::string& filename, int score);
+    // Lê um arquivo de configuração com linhas "chave=valor" (linhas vazias e
+    // começando com '#' são ignoradas). Retorna um mapa vazio se o arquivo não existir.
+    static std::map<std::string, std::string> loadSettings(const std::string& filename);
+    // Grava as chaves em values no arquivo de configuração, mantendo as outras que já estavam lá
+    static bool saveSettings(const std::string& filename, const std::map<std::string, std::string>& values);
+    // Tamanho do arquivo em bytes, ou -1 se não existir
+    static long long fileSize(const std::string& path);
 };
 
 #endif
\ No newline at end of file
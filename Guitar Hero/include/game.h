@@ -5,6 +5,16 @@
 #include <allegro5/allegro_font.h>
 #include <allegro5/allegro_audio.h>
 #include "note_manager.h" // Inclui nosso novo manager
+#include "chart_cache.h"
+#include "song_clock.h"
+#include "calibration.h"
+#include "input_thread.h"
+#include "text_cache.h"
+#include "render_list.h"
+#include "render_backend.h"
+#include "render_thread.h"
+#include "particle_system.h"
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -13,12 +23,58 @@ enum class GameState {
     MENU,
     SONG_SELECT,
     PLAYING,
-    SCORE_SCREEN
+    SCORE_SCREEN,
+    CALIBRATION
+};
+
+// Taxas do loop principal. A simulação roda em passos fixos (tick_rate) e o desenho
+// em outra taxa, com a posição das notas interpolada entre os dois últimos ticks.
+// Também guarda o tamanho do cache de charts, lido junto das outras opções.
+struct TimingSettings {
+    double tick_rate = 240.0;    // Passos de simulação por segundo
+    double frame_rate = 60.0;    // Frames por segundo (0 = sem limite)
+    bool vsync = false;          // Um frame por atualização do monitor (ignora frame_rate)
+    int max_catch_up_ticks = 25; // Máximo de ticks por frame; o atraso além disso é descartado
+    // Latências medidas na calibração, em segundos (positivo = o jogador toca atrasado)
+    double audio_offset = 0.0;   // Entre o som e o toque: desloca o tempo da música e o julgamento
+    double video_offset = 0.0;   // Entre a imagem e o toque: desloca só o desenho das notas
+    // Memória que os charts guardados no cache podem ocupar (0 = não guarda nenhum)
+    size_t chart_cache_bytes = 64 * 1024 * 1024;
+};
+
+// Aplica uma opção ("tick_rate", "frame_rate", "max_catch_up_ticks", "audio_offset_ms",
+// "video_offset_ms" ou "chart_cache_mb") lida da linha de comando ou do arquivo de
+// configuração. frame_rate aceita "uncapped" e "vsync".
+bool setTimingOption(TimingSettings& timing, const std::string& key, const std::string& value);
+
+// Contadores do loop principal, para diagnóstico
+struct LoopStats {
+    long long frames = 0;
+    long long events = 0;            // Eventos repassados para o jogo
+    long long dropped_frames = 0;    // Eventos do timer atrasados, juntados num frame só
+    long long coalesced_repeats = 0; // Repetições automáticas de tecla descartadas
+    long long deadline_frames = 0;   // Frames desenhados com eventos ainda na fila (prazo estourado)
+    long long skipped_ticks = 0;     // Ticks descartados pela política de recuperação
+    long long wakeups = 0;           // Vezes que o loop acordou (eventos, timer ou frame sem limite)
+    long long idle_waits = 0;        // Vezes que o loop dormiu com o timer parado (tela sem mudanças)
+
+    // Jitter da simulação (variação do intervalo entre frames) contra a duração do
+    // último present. Com o desenho numa thread própria, os dois não se correlacionam.
+    long long jitter_samples = 0;
+    double jitter_sum = 0;
+    double max_jitter = 0;
+    double present_sum = 0;
+    double jitter_squares = 0;
+    double present_squares = 0;
+    double jitter_present = 0;
+
+    void addJitterSample(double jitter, double present);
+    double jitterPresentCorrelation() const;
 };
 
 class Game {
 public:
-    Game();
+    explicit Game(const TimingSettings& timing = TimingSettings());
     ~Game();
 
     bool initialize();
@@ -28,21 +84,42 @@ private:
     // Variáveis de estado e Allegro
     bool running;
     GameState currentState;
+    bool screen_dirty; // A tela atual mudou e precisa ser redesenhada
     ALLEGRO_DISPLAY* display;
     ALLEGRO_EVENT_QUEUE* event_queue;
-    ALLEGRO_TIMER* timer;
+    InputThread input; // Teclado, lido numa thread própria
+    ALLEGRO_TIMER* timer; // Timer de frames (nulo sem limite de FPS ou com vsync)
+    TimingSettings timing;
+    LoopStats loop_stats;
     ALLEGRO_FONT* font; 
+    RenderList frame;    // Comandos de desenho do frame atual, montados em render()
+    RenderList playfield; // Parte fixa da tela de jogo, gravada uma vez só (camada do backend)
+    std::unique_ptr<RenderBackend> renderer; // Desenha as listas no display
+    RenderThread render_thread; // Desenha e apresenta os snapshots publicados pelo loop
+    TextCache text_cache;      // Textos da interface já renderizados (usado pela thread de desenho)
+    uint32_t display_changes;  // Resizes e displays recriados, repassados à thread de desenho
+    uint32_t display_resizes;
     ALLEGRO_SAMPLE* hit_sound;
     ALLEGRO_SAMPLE* miss_sound;
     ALLEGRO_AUDIO_STREAM* music_stream; 
+    std::string music_stream_path; // Arquivo de onde music_stream foi carregado
 
     // Gerenciador de Notas
     NoteManager noteManager;
+    ChartCache chartCache; // Charts já carregados, reaproveitados entre partidas
+    ParticleSystem effects; // Faíscas, brilho e texto dos acertos e erros
 
     // Variáveis de Gameplay
     int score;
     int final_score; // Para guardar a pontuação ao final da música
+    int hud_score;              // Valor que está em hud_score_text
+    std::string hud_score_text; // "Score: N", refeito só quando o score muda
     float song_position;
+    float previous_song_position; // song_position do tick anterior (para interpolar)
+    double song_position_timestamp; // Instante (base de al_get_time) a que song_position se refere
+    double sim_time; // Instante (base de al_get_time) que a simulação já alcançou: avança um tick por update
+    SongClock song_clock; // Tempo da música suavizado a partir da posição do áudio
+    Calibration calibration;
     std::string selectedSongPath;
     bool music_started;
 
@@ -54,9 +131,12 @@ private:
 
 
     // Funções de loop principal, divididas por estado
+    void dispatchEvent(const ALLEGRO_EVENT& event, bool& frame_due);
     void processEvent(const ALLEGRO_EVENT& event);
+    void drainInput();
     void update(float delta_time);
-    void render();
+    // Monta em frame os comandos de desenho do estado atual; quem desenha é a thread de desenho
+    void render(float alpha);
 
     // Funções específicas de cada estado
     void updateMenu(const ALLEGRO_EVENT& event);
@@ -66,15 +146,25 @@ private:
     void renderSongSelect();
     
     void updatePlaying(const ALLEGRO_EVENT& event, float delta_time);
-    void renderPlaying();
+    void renderPlaying(float alpha);
+    void drawPlayfield(RenderList& list);
 
     void updateScoreScreen(const ALLEGRO_EVENT& event);
     void renderScoreScreen();
+
+    void updateCalibration(const ALLEGRO_EVENT& event);
+    void renderCalibration();
     
     // Funções auxiliares
     void startPlaying();
+    void judgePress(int key_code, double press_time);
     void endPlaying();
+    void destroyMusicStream();
     void loadSongList();
+    void startCalibration();
+    void warmText();
+    bool isAnimated() const;
+    double toSongTime(double timestamp) const;
 };
 
 #endif
\ No newline at end of file
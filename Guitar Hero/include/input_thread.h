@@ -0,0 +1,63 @@
+#ifndef INPUT_THREAD_H
+#define INPUT_THREAD_H
+
+#include <allegro5/allegro5.h>
+#include <atomic>
+#include <thread>
+#include <cstddef>
+#include <cstdint>
+#include "spsc_ring.h"
+
+// Um evento de teclado já com o instante convertido para o tempo da música
+struct InputRecord {
+    double timestamp;  // Base de al_get_time (como event.keyboard.timestamp)
+    double song_time;  // Tempo da música no instante do toque
+    int16_t keycode;
+    uint8_t type;      // ALLEGRO_EVENT_KEY_DOWN ou ALLEGRO_EVENT_KEY_UP
+};
+
+// Eventos de usuário da thread de input
+const int INPUT_WAKE_EVENT = ALLEGRO_GET_EVENT_TYPE('G', 'H', 'I', 'W'); // Chegou tecla na fila
+const int INPUT_STOP_EVENT = ALLEGRO_GET_EVENT_TYPE('G', 'H', 'I', 'S'); // Pede para a thread parar
+
+// Thread dedicada ao teclado, com a sua própria fila de eventos da Allegro.
+// Cada tecla é marcada no relógio da música assim que chega e vai para uma fila
+// SPSC que a simulação esvazia a cada tick, então o toque não espera o desenho
+// nem o al_flip_display (que pode bloquear no vsync) para ser registrado.
+// A thread só acorda quando chega um evento, e a cada tecla emite INPUT_WAKE_EVENT
+// em wakeSource(), para acordar o loop principal se ele estiver parado.
+class InputThread {
+public:
+    InputThread();
+    ~InputThread();
+    InputThread(const InputThread&) = delete;
+    InputThread& operator=(const InputThread&) = delete;
+
+    // Registra o teclado na fila da thread; false se não der (o jogo usa a fila principal)
+    bool start();
+    void stop();
+
+    // Chamado pela simulação: o tempo da música era song_time no instante timestamp
+    void publishSongClock(double song_time, double timestamp);
+    bool pop(InputRecord& record) { return ring.pop(record); }
+    size_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+    ALLEGRO_EVENT_SOURCE* wakeSource() { return &wake_source; }
+
+private:
+    SpscRing<InputRecord> ring;
+    ALLEGRO_EVENT_QUEUE* queue;
+    std::thread worker;
+    ALLEGRO_EVENT_SOURCE wake_source;
+    ALLEGRO_EVENT_SOURCE stop_source;
+    std::atomic<size_t> dropped; // Eventos perdidos com a fila cheia
+
+    // Âncora do relógio da música, protegida por um seqlock (um escritor só)
+    std::atomic<uint32_t> clock_sequence;
+    std::atomic<double> clock_song_time;
+    std::atomic<double> clock_timestamp;
+
+    double songTimeAt(double timestamp) const;
+    void run();
+};
+
+#endif // INPUT_THREAD_H
@@ -3,15 +3,70 @@
 
 #include <vector>
 #include <string>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <allegro5/allegro5.h>
+#include <allegro5/allegro_primitives.h>
+#include "chart_file.h"
+#include "chart_stream.h"
+#include "render_list.h"
 
-struct Note {
-    float time;
-    float y_position;
+// Estado de cada nota, empacotado em um byte
+enum NoteState : uint8_t {
+    NOTE_ACTIVE = 1 << 0,
+    NOTE_HIT    = 1 << 1,
+    NOTE_MISSED = 1 << 2
+};
+
+// --- Julgamento dos acertos ---
+enum class JudgementTier {
+    PERFECT,
+    GREAT,
+    GOOD,
+    MISS
+};
+const int NUM_JUDGEMENT_TIERS = 4;
+
+// Janelas de acerto em segundos (para antes e para depois do tempo da nota).
+// Depois da janela "good" a nota é considerada perdida.
+struct TimingWindows {
+    double perfect = 0.035;
+    double great = 0.070;
+    double good = 0.100;
+};
+
+// Resultado de um toque julgado
+struct Judgement {
+    JudgementTier tier;
     int track;
-    bool active;
-    bool hit;
-    bool missed;
+    float offset; // press_time - note.time, em segundos (negativo = adiantado)
+};
+
+int judgementPoints(JudgementTier tier);
+
+// Estado de julgamento de uma partida sobre um chart: tudo o que muda enquanto se joga.
+// O chart em si é imutável e compartilhado; cada jogador (ou bot) tem o seu estado.
+struct JudgementState {
+    std::vector<uint8_t> notes; // Um byte por nota do chart, combinação de NoteState
+
+    // Janela de notas visíveis: [head, tail)
+    // head = primeira nota ainda não finalizada (nem acertada nem perdida)
+    // tail = primeira nota que ainda não foi ativada
+    size_t head;
+    size_t tail;
+
+    // Próxima nota ainda não julgada de cada trilha (posição na fila da trilha)
+    size_t lane_head[NUM_TRACKS];
+
+    // Contadores mantidos a cada mudança de estado, para consultas O(1)
+    int active_count;
+    int hit_count;
+    int missed_count;
+    int tier_counts[NUM_JUDGEMENT_TIERS];
+
+    // Recomeça a partida: só zera memória, não aloca se o tamanho for o mesmo
+    void reset(size_t note_count);
 };
 
 class NoteManager {
@@ -19,19 +74,85 @@ public:
     NoteManager();
 
     void loadSong(const std::string& filename);
-    void update(float song_position, float delta_time);
-    void render();
-    int checkHit(int key_code);
+    // Usa um chart já carregado (por exemplo, vindo do ChartCache).
+    // Se for o mesmo chart da partida anterior, só zera o estado da partida.
+    void setChart(std::shared_ptr<const Chart> new_chart);
+    // Lê o chart aos poucos, guardando só as notas até lookahead_seconds à frente
+    // (para charts muito longos, com memória limitada)
+    void streamSong(const std::string& filename, double lookahead_seconds);
+    void restart();
+    void update(float song_position);
+    // Grava em list o desenho das notas na posição do instante song_position (pode ficar
+    // entre duas chamadas de update, para interpolar o movimento entre ticks).
+    void render(float song_position, RenderList& list);
+    // press_time é o instante do toque já convertido para o tempo da música (segundos).
+    // Retorna true e preenche judgement se o toque acertou alguma nota.
+    bool checkHit(int key_code, double press_time, Judgement& judgement);
+    void setTimingWindows(const TimingWindows& windows);
     void reset();
 
+    bool isSongLoaded() const { return chart != nullptr || stream != nullptr; }
+    bool isStreaming() const { return stream != nullptr; }
     bool isSongFinished() const;
+    bool hasStreamFailed() const { return stream && stream->failed(); }
     int getActiveNotesCount() const;
+    int getTierCount(JudgementTier tier) const;
+    // Trilhas (um bit por trilha) com alguma nota perdida no último update
+    uint8_t missedTracks() const { return missed_tracks; }
+
+    // Cor das notas de cada trilha
+    static ALLEGRO_COLOR keyToColor(int track);
 
 private:
-    std::vector<Note> notes;
-    float note_speed; // << NOVO: Velocidade agora é uma variável
+    // Notas guardadas como "struct of arrays", sempre ordenadas por tempo.
+    // O índice i de cada vetor se refere à mesma nota. Tempo, trilha e filas por
+    // trilha apontam direto para dentro do chart (compartilhado, só leitura).
+    // No modo streaming apontam para uma janela circular: a nota i fica na posição
+    // i & slot_mask. Com o chart inteiro carregado, slot_mask tem todos os bits ligados.
+    std::shared_ptr<const Chart> chart;
+    size_t note_count; // Total de notas do chart
+    size_t received;   // Notas já disponíveis (todas, fora do modo streaming)
+    size_t slot_mask;
+    const float* note_time;
+    const uint8_t* note_track;
+    const uint32_t* lane_notes[NUM_TRACKS];
+    size_t lane_size[NUM_TRACKS];
+
+    // Estado desta partida
+    JudgementState state;
+
+    // Modo streaming: leitor em outra thread e a janela circular de notas
+    std::unique_ptr<ChartStream> stream;
+    std::string stream_path;
+    std::vector<float> stream_time;
+    std::vector<uint8_t> stream_track;
+    std::vector<uint32_t> stream_lanes[NUM_TRACKS];
+
+    // Distância de rolagem (pixels) no último update; decide quais notas já entraram na tela.
+    double scroll_position;
+    uint8_t missed_tracks;
+
+    TimingWindows timing_windows;
+
+    // Desenho em lote: as notas visíveis vão para um único lote de triângulos da lista.
+    // Cada nota é uma elipse (centro + contorno) copiada de um molde pré-calculado.
+    // Os índices, iguais para todo frame, são montados aqui e copiados para a lista
+    // junto com os vértices (a lista pode ser desenhada em outra thread).
+    std::vector<int> note_indices;
+    size_t batch_capacity; // Notas que cabem em note_indices
+
+    float timeOf(size_t i) const { return note_time[i & slot_mask]; }
+    int trackOf(size_t i) const { return note_track[i & slot_mask]; }
+    uint8_t& stateOf(size_t i) { return state.notes[i & slot_mask]; }
+    uint8_t stateOf(size_t i) const { return state.notes[i & slot_mask]; }
+    size_t laneNote(int track, size_t k) const { return lane_notes[track][k & slot_mask]; }
 
-    ALLEGRO_COLOR keyToColor(int track);
+    void receiveStreamedNotes(double song_position);
+    float noteY(size_t i, double scroll) const;
+    bool isJudged(size_t i) const;
+    void advanceHead();
+    void advanceLane(int track);
+    void reserveBatch(size_t notes);
 };
 
-#endif // NOTE_MANAGER_H
\ No newline at end of file
+#endif // NOTE_MANAGER_H
@@ -0,0 +1,68 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include <allegro5/allegro5.h>
+#include <allegro5/allegro_font.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "note_manager.h"
+#include "render_list.h"
+
+// Efeitos de acerto e de erro: faíscas, brilho na trilha e o texto do julgamento.
+// As partículas ficam num pool "struct of arrays" alocado uma vez só, com limite
+// fixo: efeitos pedidos com o pool cheio são descartados (e contados), então
+// acordes pesados não estouram o custo do frame. Todas as partículas vão para um
+// único lote de triângulos da lista.
+class ParticleSystem {
+public:
+    explicit ParticleSystem(size_t max_particles);
+
+    void hit(int track, JudgementTier tier);
+    void miss(int track);
+    void update(float delta_time);
+    void render(RenderList& list, ALLEGRO_FONT* font) const;
+    // Remove todos os efeitos e zera as estatísticas (nova partida)
+    void clear();
+
+    size_t liveCount() const { return count; }
+    size_t peakCount() const { return peak; }
+    double averageCount() const { return samples ? static_cast<double>(count_sum) / samples : 0.0; }
+    size_t droppedCount() const { return dropped; }
+
+    // Texto e cor do julgamento, para aquecer o cache de textos
+    static const char* judgementText(JudgementTier tier);
+    static ALLEGRO_COLOR judgementColor(JudgementTier tier);
+
+private:
+    // Cada partícula é um retângulo alinhado aos eixos que some aos poucos
+    size_t capacity;
+    size_t count;
+    std::vector<float> x, y;          // Centro
+    std::vector<float> vx, vy;        // Velocidade (pixels/s)
+    std::vector<float> ay;            // Aceleração vertical (gravidade das faíscas)
+    std::vector<float> half_w, half_h;
+    std::vector<float> life;          // Segundos restantes
+    std::vector<float> inv_lifetime;  // 1 / duração total, para o fade
+    std::vector<float> r, g, b;
+    std::vector<int> indices;         // Dois triângulos por partícula, montados uma vez só
+
+    // Texto do último julgamento, acima da pista
+    JudgementTier popup_tier;
+    float popup_life;
+
+    uint32_t rng_state; // xorshift32: espalha as faíscas sem alocar nem travar
+
+    size_t peak;
+    size_t dropped;
+    unsigned long long count_sum;
+    unsigned long long samples;
+
+    bool spawn(float px, float py, float pvx, float pvy, float pay, float hw, float hh,
+               float lifetime, ALLEGRO_COLOR color);
+    void flash(int track, ALLEGRO_COLOR color);
+    void removeExpired();
+    float random(float low, float high);
+};
+
+#endif // PARTICLE_SYSTEM_H
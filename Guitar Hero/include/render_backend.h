@@ -0,0 +1,90 @@
+#ifndef RENDER_BACKEND_H
+#define RENDER_BACKEND_H
+
+#include <allegro5/allegro5.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "render_list.h"
+#include "text_cache.h"
+
+// Quem consome as listas de comandos. Os dois backends rasterizam com a Allegro;
+// a diferença é o destino: o backbuffer do display ou um bitmap em memória.
+// Todos os bitmaps usados no desenho (camada fixa, textos em cache) são criados e
+// destruídos pela thread que desenha.
+class RenderBackend {
+public:
+    RenderBackend();
+    virtual ~RenderBackend();
+    RenderBackend(const RenderBackend&) = delete;
+    RenderBackend& operator=(const RenderBackend&) = delete;
+
+    // Textos (RenderOp::TEXT) passam pelo cache; sem cache, al_draw_text direto
+    void setTextCache(TextCache* cache) { text_cache = cache; }
+    // Camada fixa desenhada por RenderOp::LAYER. A lista precisa continuar válida
+    // e sem mudanças enquanto o backend estiver em uso.
+    void setLayer(const RenderList* list);
+
+    // Desenha a lista em target
+    void execute(const RenderList& list, ALLEGRO_BITMAP* target);
+    // Desenha a lista como o próximo frame e o apresenta
+    virtual void present(const RenderList& list) = 0;
+    // Torna o destino atual na thread que chamou (a que vai desenhar)
+    virtual void bindTarget() = 0;
+    // O display mudou de tamanho (resized) ou foi recriado: refaz a camada e os textos
+    virtual void displayChanged(bool resized);
+    // Flags para criar bitmaps compatíveis com o destino (camadas, textos em cache)
+    virtual int bitmapFlags() const = 0;
+    size_t framesPresented() const { return frames; }
+
+protected:
+    size_t frames = 0;
+
+private:
+    TextCache* text_cache;
+    const RenderList* layer_list;
+    ALLEGRO_BITMAP* layer_bitmap; // layer_list já desenhada, do tamanho do destino
+    bool layer_dirty;
+    std::string text_scratch;     // Texto do comando atual (reaproveita a memória)
+
+    void drawLayer(ALLEGRO_BITMAP* target);
+};
+
+// Desenha no display e troca os buffers (al_flip_display)
+class DisplayRenderBackend : public RenderBackend {
+public:
+    explicit DisplayRenderBackend(ALLEGRO_DISPLAY* display);
+    void present(const RenderList& list) override;
+    void bindTarget() override;
+    void displayChanged(bool resized) override;
+    int bitmapFlags() const override;
+
+private:
+    ALLEGRO_DISPLAY* display;
+};
+
+// Rasteriza num bitmap em memória (ALLEGRO_MEMORY_BITMAP), sem display nem GPU.
+// O último frame pode ser copiado em RGBA ou resumido num hash, para comparar
+// capturas entre builds.
+class HeadlessRenderBackend : public RenderBackend {
+public:
+    HeadlessRenderBackend(int width, int height);
+    ~HeadlessRenderBackend();
+
+    bool isValid() const { return frame != nullptr; }
+    void present(const RenderList& list) override;
+    void bindTarget() override;
+    int bitmapFlags() const override;
+
+    ALLEGRO_BITMAP* frameBitmap() const { return frame; }
+    // Pixels do último frame, RGBA 8 bits por canal, linha a linha de cima para baixo
+    bool capture(std::vector<uint8_t>& rgba) const;
+    // FNV-1a de 32 bits dos pixels do último frame
+    uint32_t frameHash() const;
+
+private:
+    ALLEGRO_BITMAP* frame;
+};
+
+#endif // RENDER_BACKEND_H
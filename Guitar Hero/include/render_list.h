@@ -0,0 +1,85 @@
+#ifndef RENDER_LIST_H
+#define RENDER_LIST_H
+
+#include <allegro5/allegro5.h>
+#include <allegro5/allegro_font.h>
+#include <allegro5/allegro_primitives.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class RenderOp : uint8_t {
+    CLEAR,
+    FILLED_RECTANGLE,
+    LINE,
+    FILLED_ELLIPSE, // Círculos são elipses com os dois raios iguais
+    TRIANGLES,      // Lote de triângulos indexados (ex.: todas as notas)
+    TEXT,
+    BITMAP,
+    LAYER           // Camada fixa guardada pelo backend (ex.: o playfield)
+};
+
+// Um comando de desenho. O significado dos campos depende de op:
+//   FILLED_RECTANGLE, LINE  (x1, y1) e (x2, y2) são os cantos / as pontas
+//   FILLED_ELLIPSE          (x1, y1) é o centro, x2 e y2 os raios
+//   TEXT, BITMAP            (x1, y1) é a posição
+struct RenderCommand {
+    RenderOp op;
+    int flags;             // Alinhamento do texto
+    ALLEGRO_COLOR color;
+    float x1, y1, x2, y2;
+    float thickness;       // Espessura da linha
+    const void* resource;  // ALLEGRO_FONT* (TEXT) ou ALLEGRO_BITMAP* (BITMAP)
+    uint32_t first;        // Primeiro vértice (TRIANGLES) ou caractere (TEXT)
+    uint32_t count;        // Quantidade de vértices (TRIANGLES) ou de caracteres (TEXT)
+    uint32_t first_index;  // TRIANGLES: primeiro índice, em indexData()
+    uint32_t index_count;
+};
+
+// Lista de comandos de um frame (ou de uma camada, como o playfield). As funções de
+// render só preenchem a lista; quem desenha de fato é um RenderBackend. Vértices,
+// índices e textos ficam em vetores da própria lista, reaproveitados de um frame para
+// o outro: a lista não aponta para memória de quem a montou, então pode ser desenhada
+// em outra thread enquanto o jogo segue mudando o próprio estado.
+class RenderList {
+public:
+    RenderList() : batch_start(0) {}
+
+    void clear();
+
+    void clearTo(ALLEGRO_COLOR color);
+    void filledRectangle(float x1, float y1, float x2, float y2, ALLEGRO_COLOR color);
+    void line(float x1, float y1, float x2, float y2, ALLEGRO_COLOR color, float thickness);
+    void filledCircle(float cx, float cy, float radius, ALLEGRO_COLOR color);
+    void filledEllipse(float cx, float cy, float rx, float ry, ALLEGRO_COLOR color);
+    // Lote de triângulos indexados: beginTriangles reserva até max_vertices vértices e
+    // devolve onde escrevê-los; endTriangles fecha o lote com os vértices realmente usados.
+    // indices (relativos ao primeiro vértice do lote) é copiado para a lista, então só
+    // precisa ser válido durante a chamada.
+    ALLEGRO_VERTEX* beginTriangles(size_t max_vertices);
+    void endTriangles(size_t vertex_count, const int* indices, size_t index_count);
+    void text(ALLEGRO_FONT* font, ALLEGRO_COLOR color, float x, float y, int flags, const std::string& str);
+    void bitmap(ALLEGRO_BITMAP* bitmap, float x, float y);
+    // Desenha a camada fixa do backend (RenderBackend::setLayer)
+    void layer();
+
+    // Troca o conteúdo com other sem copiar (as duas mantêm a memória já reservada)
+    void swap(RenderList& other);
+
+    const std::vector<RenderCommand>& commands() const { return command_list; }
+    const ALLEGRO_VERTEX* vertexData() const { return vertices.data(); }
+    const int* indexData() const { return indices.data(); }
+    const char* textData() const { return characters.data(); }
+
+private:
+    std::vector<RenderCommand> command_list;
+    std::vector<ALLEGRO_VERTEX> vertices;
+    std::vector<int> indices;
+    std::vector<char> characters; // Textos terminados em '\0', um depois do outro
+    size_t batch_start;           // Primeiro vértice do lote aberto por beginTriangles
+
+    RenderCommand& add(RenderOp op, ALLEGRO_COLOR color);
+};
+
+#endif // RENDER_LIST_H
@@ -0,0 +1,77 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <allegro5/allegro5.h>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "render_backend.h"
+#include "render_list.h"
+#include "triple_buffer.h"
+
+// Estado imutável de um frame, publicado pela simulação para a thread de desenho
+struct FrameSnapshot {
+    RenderList list;            // Comandos do frame (notas, placar, textos da tela)
+    uint32_t display_changes = 0; // Contadores de mudanças do display, para refazer bitmaps
+    uint32_t display_resizes = 0;
+};
+
+// Contadores da thread de desenho, para diagnóstico
+struct RenderStats {
+    long long published = 0;      // Snapshots publicados pela simulação
+    long long presented = 0;      // Frames desenhados e apresentados
+    double present_seconds = 0;   // Tempo total dentro do present (inclui a espera do vsync)
+    double max_present_seconds = 0;
+};
+
+// Eventos de usuário da thread de desenho
+const int RENDER_FRAME_EVENT = ALLEGRO_GET_EVENT_TYPE('G', 'H', 'R', 'F'); // Snapshot novo publicado
+const int RENDER_STOP_EVENT = ALLEGRO_GET_EVENT_TYPE('G', 'H', 'R', 'S');  // Pede para a thread parar
+
+// Thread dedicada ao desenho. A simulação monta a lista de comandos do frame e a
+// publica num buffer triplo sem locks; esta thread desenha sempre o último snapshot
+// publicado e apresenta (al_flip_display, que pode bloquear no vsync) sem segurar a
+// simulação nem o input. Snapshots que chegam mais rápido do que a tela são
+// descartados. A thread só acorda quando um snapshot é publicado.
+// Sem a thread (start falhou ou não foi chamado), publish desenha na hora, na
+// thread que chamou.
+class RenderThread {
+public:
+    RenderThread();
+    ~RenderThread();
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // Passa o destino do backend para a thread nova. Depois disso, a thread que
+    // chamou não pode mais desenhar nem criar bitmaps de vídeo.
+    bool start(RenderBackend* backend);
+    // Para a thread e devolve o destino para quem chamou
+    void stop();
+    void setBackend(RenderBackend* new_backend) { backend = new_backend; }
+
+    // Chamado pela simulação. Troca list com o slot livre do buffer (sem cópia):
+    // depois da chamada, list tem o conteúdo de um frame antigo e deve ser limpa.
+    void publish(RenderList& list, uint32_t display_changes, uint32_t display_resizes);
+
+    // Duração do último present, em segundos (pode ser lida de qualquer thread)
+    double lastPresentSeconds() const { return last_present.load(std::memory_order_relaxed); }
+    // Válido depois de stop (ou sem a thread)
+    const RenderStats& stats() const { return render_stats; }
+
+private:
+    TripleBuffer<FrameSnapshot> snapshots;
+    RenderBackend* backend;
+    ALLEGRO_EVENT_QUEUE* queue;
+    std::thread worker;
+    ALLEGRO_EVENT_SOURCE frame_source;
+    ALLEGRO_EVENT_SOURCE stop_source;
+    std::atomic<double> last_present;
+    RenderStats render_stats;
+    uint32_t seen_changes; // Mudanças do display já tratadas pela thread de desenho
+    uint32_t seen_resizes;
+
+    void present(const FrameSnapshot& snapshot);
+    void run();
+};
+
+#endif // RENDER_THREAD_H
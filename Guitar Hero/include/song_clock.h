@@ -0,0 +1,51 @@
+#ifndef SONG_CLOCK_H
+#define SONG_CLOCK_H
+
+#include <cstddef>
+
+// Estatísticas do erro entre o relógio e a posição informada pelo áudio (segundos)
+struct SongClockStats {
+    size_t samples = 0;   // Leituras do áudio comparadas com o relógio
+    size_t snaps = 0;     // Vezes em que o erro era grande demais e o relógio saltou
+    double sum = 0;
+    double sum_squares = 0;
+    double max_abs = 0;
+    double last = 0;
+
+    double mean() const { return samples ? sum / samples : 0; }
+    double rms() const;
+};
+
+// Relógio da música suavizado. A posição do stream de áudio só anda em saltos do
+// tamanho de um fragmento (dezenas de ms); o relógio extrapola a partir de um
+// relógio monotônico (al_get_time) e corrige a fase e a velocidade aos poucos, como
+// um PLL, sempre que a leitura do áudio muda. O tempo devolvido nunca volta para trás.
+class SongClock {
+public:
+    SongClock();
+
+    // Recomeça em song_time no instante now (ex.: início da música)
+    void start(double song_time, double now);
+    // Compara com a posição do áudio lida em now e devolve o tempo da música em now
+    double update(double audio_position, double now);
+    // Tempo da música em now, extrapolado desde o último update
+    double timeAt(double now) const;
+
+    double rate() const { return rate_; }
+    const SongClockStats& stats() const { return stats_; }
+
+private:
+    double base_time;      // Tempo da música em base_now
+    double base_now;
+    double rate_;          // Segundos de música por segundo de relógio
+    double drift;          // Parte integral da correção de velocidade
+    double last_audio;     // Última leitura do áudio (para detectar quando ela muda)
+    double last_edge_now;  // Instante da última mudança na leitura do áudio
+    double last_output;
+    bool locked;           // Já viu a primeira mudança na leitura do áudio
+    SongClockStats stats_;
+
+    void snap(double audio_position);
+};
+
+#endif // SONG_CLOCK_H
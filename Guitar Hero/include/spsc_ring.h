@@ -0,0 +1,60 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Fila circular sem locks para exatamente um produtor e um consumidor,
+// cada um na sua thread. A capacidade é arredondada para uma potência de 2.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t min_capacity) : read_index(0), write_index(0) {
+        size_t capacity = 1;
+        while (capacity < min_capacity) capacity <<= 1;
+        buffer.resize(capacity);
+        mask = capacity - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Só o produtor chama
+    bool push(const T& item) {
+        const size_t write = write_index.load(std::memory_order_relaxed);
+        if (write - read_index.load(std::memory_order_acquire) > mask) return false; // Cheia
+        buffer[write & mask] = item;
+        write_index.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Só o consumidor chama
+    bool pop(T& item) {
+        const size_t read = read_index.load(std::memory_order_relaxed);
+        if (read == write_index.load(std::memory_order_acquire)) return false; // Vazia
+        item = buffer[read & mask];
+        read_index.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Aproximado se chamado enquanto a outra thread mexe na fila
+    size_t size() const {
+        return write_index.load(std::memory_order_acquire) - read_index.load(std::memory_order_acquire);
+    }
+    size_t capacity() const { return mask + 1; }
+    void clear() {
+        read_index.store(0);
+        write_index.store(0);
+    }
+
+private:
+    std::vector<T> buffer;
+    size_t mask;
+
+    // Em linhas de cache separadas para produtor e consumidor não disputarem a mesma
+    alignas(64) std::atomic<size_t> read_index;
+    alignas(64) std::atomic<size_t> write_index;
+};
+
+#endif // SPSC_RING_H
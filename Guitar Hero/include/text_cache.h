@@ -0,0 +1,71 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include <allegro5/allegro5.h>
+#include <allegro5/allegro_font.h>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Cache LRU de textos já renderizados. Cada combinação (fonte, texto, cor) vira um
+// bitmap do tamanho do texto, desenhado uma vez só; depois cada frame faz só um blit,
+// sem formatar nem rasterizar os glifos de novo.
+// Números mudam o tempo todo (placar, contadores), então cada algarismo é guardado
+// como uma entrada própria e o texto entre eles como outra: um placar novo reaproveita
+// os mesmos bitmaps em vez de ocupar uma entrada nova e empurrar as outras para fora.
+class TextCache {
+public:
+    explicit TextCache(size_t max_entries);
+    ~TextCache();
+    TextCache(const TextCache&) = delete;
+    TextCache& operator=(const TextCache&) = delete;
+
+    // Mesmo resultado de al_draw_text (flags aceita ALLEGRO_ALIGN_*). Usado pelo
+    // RenderBackend, na thread que desenha, para os comandos de texto da lista.
+    void draw(ALLEGRO_FONT* font, ALLEGRO_COLOR color, float x, float y, int flags, const std::string& text);
+    // Renderiza o texto antes de ele ser usado (e carrega os glifos da fonte TTF)
+    void warm(ALLEGRO_FONT* font, ALLEGRO_COLOR color, const std::string& text);
+    // Descarta todos os bitmaps (ex.: display recriado)
+    void clear();
+
+    size_t entryCount() const { return entries.size(); }
+    size_t hits() const { return hit_count; }
+    size_t misses() const { return miss_count; }
+
+private:
+    struct Key {
+        ALLEGRO_FONT* font;
+        uint32_t color; // RGBA, 8 bits por canal
+        std::string text;
+        bool operator==(const Key& other) const {
+            return font == other.font && color == other.color && text == other.text;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    struct Entry {
+        Key key;
+        ALLEGRO_BITMAP* bitmap; // Nulo para texto vazio
+        int offset_x;           // Canto do bitmap em relação à posição do texto
+        int offset_y;
+        int advance;            // Largura usada no alinhamento (al_get_text_width)
+    };
+
+    // Mais recente no começo da lista
+    std::list<Entry> entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    size_t max_entries;
+    size_t hit_count;
+    size_t miss_count;
+    std::vector<const Entry*> segments; // Pedaços do texto sendo desenhado
+
+    // Procura (ou cria) as entradas de cada pedaço do texto e devolve a largura total
+    int split(ALLEGRO_FONT* font, ALLEGRO_COLOR color, const std::string& text);
+    const Entry& lookup(ALLEGRO_FONT* font, ALLEGRO_COLOR color, const std::string& text);
+};
+
+#endif // TEXT_CACHE_H
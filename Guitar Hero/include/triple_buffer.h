@@ -0,0 +1,44 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Buffer triplo sem locks para um escritor e um leitor, cada um na sua thread.
+// O escritor preenche back() e publica; o leitor pega sempre o último valor
+// publicado (os intermediários que ele não chegou a ver são descartados).
+// Nenhum dos dois espera pelo outro: cada um tem o seu slot, e o terceiro fica
+// no meio, trocado atomicamente.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : back_index(0), middle(1), front_index(2) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Só o escritor chama
+    T& back() { return slots[back_index]; }
+    void publish() {
+        back_index = middle.exchange(back_index | NEW_DATA, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Só o leitor chama. Retorna true se havia um valor novo (que passa a ser front())
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & NEW_DATA)) return false;
+        front_index = middle.exchange(front_index, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+    T& front() { return slots[front_index]; }
+
+private:
+    static const uint8_t INDEX_MASK = 0x3;
+    static const uint8_t NEW_DATA = 0x4; // O slot do meio foi publicado e ainda não lido
+
+    T slots[3];
+    uint8_t back_index;          // Do escritor
+    std::atomic<uint8_t> middle; // Índice do slot do meio + NEW_DATA
+    uint8_t front_index;         // Do leitor
+};
+
+#endif // TRIPLE_BUFFER_H
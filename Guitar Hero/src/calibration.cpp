@@ -0,0 +1,101 @@
+#include "calibration.h"
+#include <algorithm>
+#include <cmath>
+
+const double BEAT_INTERVAL = 0.5; // 120 BPM
+const double LEAD_IN = 1.0;       // Espera antes da primeira batida de cada fase
+const double TRIM = 0.25;         // Descarta o quartil de cima e o de baixo
+
+double trimmedMean(std::vector<double> values, double trim) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    size_t cut = static_cast<size_t>(values.size() * trim);
+    double sum = 0;
+    for (size_t i = cut; i < values.size() - cut; ++i) sum += values[i];
+    return sum / (values.size() - 2 * cut);
+}
+
+double median(std::vector<double> values) {
+    if (values.empty()) return 0;
+    size_t middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + middle, values.end());
+    double upper = values[middle];
+    if (values.size() % 2 == 1) return upper;
+    double lower = *std::max_element(values.begin(), values.begin() + middle);
+    return (lower + upper) / 2;
+}
+
+Calibration::Calibration()
+    : current_phase(Phase::DONE), phase_start(0), next_click(0), taps(0),
+      audio_offset(0), video_offset(0), audio_median(0), video_median(0) {}
+
+void Calibration::start(double now) {
+    audio_offset = video_offset = 0;
+    audio_median = video_median = 0;
+    startPhase(Phase::AUDIO, now);
+}
+
+void Calibration::startPhase(Phase phase, double now) {
+    current_phase = phase;
+    phase_start = now + LEAD_IN;
+    next_click = 0;
+    beat_times.clear();
+    offsets.clear();
+    taps = 0;
+}
+
+double Calibration::beatInterval() const {
+    return BEAT_INTERVAL;
+}
+
+bool Calibration::updateClick(double now) {
+    if (current_phase != Phase::AUDIO) return false;
+    if (now < phase_start + next_click * BEAT_INTERVAL) return false;
+    // Os toques são comparados com o instante em que o clique saiu, não com o previsto
+    beat_times.push_back(now);
+    if (beat_times.size() > 4) beat_times.erase(beat_times.begin());
+    next_click++;
+    return true;
+}
+
+double Calibration::timeToNextBeat(double now) const {
+    double beats = (now - phase_start) / BEAT_INTERVAL;
+    if (beats < 0) return phase_start - now;
+    return (std::floor(beats) + 1 - beats) * BEAT_INTERVAL;
+}
+
+double Calibration::nearestBeat(double time) const {
+    if (current_phase == Phase::AUDIO) {
+        double nearest = -1;
+        for (double beat : beat_times) {
+            if (nearest < 0 || std::fabs(time - beat) < std::fabs(time - nearest)) nearest = beat;
+        }
+        return nearest;
+    }
+    double k = std::round((time - phase_start) / BEAT_INTERVAL);
+    return k < 0 ? -1 : phase_start + k * BEAT_INTERVAL;
+}
+
+int Calibration::measuredTaps() const {
+    return static_cast<int>(offsets.size());
+}
+
+void Calibration::tap(double time) {
+    if (current_phase == Phase::DONE) return;
+    double beat = nearestBeat(time);
+    if (beat < 0 || std::fabs(time - beat) > BEAT_INTERVAL / 2) return;
+
+    if (++taps <= WARMUP_TAPS) return;
+    offsets.push_back(time - beat);
+    if (measuredTaps() < MEASURED_TAPS) return;
+
+    if (current_phase == Phase::AUDIO) {
+        audio_offset = trimmedMean(offsets, TRIM);
+        audio_median = median(offsets);
+        startPhase(Phase::VIDEO, time);
+    } else {
+        video_offset = trimmedMean(offsets, TRIM);
+        video_median = median(offsets);
+        current_phase = Phase::DONE;
+    }
+}
@@ -0,0 +1,63 @@
+#include "chart_cache.h"
+#include <sys/stat.h>
+
+ChartCache::ChartCache(size_t capacity_bytes)
+    : capacity_bytes(capacity_bytes), used_bytes(0), hit_count(0), miss_count(0) {}
+
+std::shared_ptr<const Chart> ChartCache::load(const std::string& path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return nullptr;
+    const int64_t mtime = static_cast<int64_t>(info.st_mtime);
+    const uint64_t file_size = static_cast<uint64_t>(info.st_size);
+
+    auto found = index.find(path);
+    if (found != index.end()) {
+        auto it = found->second;
+        if (it->mtime == mtime && it->file_size == file_size) {
+            hit_count++;
+            entries.splice(entries.begin(), entries, it); // Vira o mais recente
+            return it->chart;
+        }
+        // O arquivo mudou: descarta a versão antiga
+        erase(it);
+    }
+
+    miss_count++;
+    auto chart = std::make_shared<Chart>();
+    if (!loadChart(path, *chart)) return nullptr;
+
+    // Um chart maior que o cache inteiro é usado, mas não guardado
+    const size_t bytes = chart->byteSize();
+    if (bytes > capacity_bytes) return chart;
+
+    entries.push_front({path, mtime, file_size, chart, bytes});
+    index[path] = entries.begin();
+    used_bytes += bytes;
+    evict();
+    return chart;
+}
+
+void ChartCache::setCapacity(size_t new_capacity) {
+    capacity_bytes = new_capacity;
+    evict();
+}
+
+void ChartCache::clear() {
+    entries.clear();
+    index.clear();
+    used_bytes = 0;
+}
+
+void ChartCache::erase(std::list<Entry>::iterator it) {
+    used_bytes -= it->bytes;
+    index.erase(it->path);
+    entries.erase(it);
+}
+
+// Remove os menos usados até caber na capacidade.
+// Quem ainda estiver usando um chart removido continua com a sua cópia (shared_ptr).
+void ChartCache::evict() {
+    while (used_bytes > capacity_bytes && !entries.empty()) {
+        erase(std::prev(entries.end()));
+    }
+}
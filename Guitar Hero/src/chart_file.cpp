@@ -0,0 +1,665 @@
+#include "chart_file.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <charconv>
+#include <cmath>
+#include <sys/stat.h>
+#include <allegro5/allegro5.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// O cabeçalho é gravado byte a byte no arquivo, então o tamanho não pode mudar
+static_assert(sizeof(ChartFileHeader) == 96, "cabeçalho do .ghc deve ter 96 bytes");
+
+// Tamanho dos pedaços lidos ao compilar um chart sem carregá-lo inteiro
+const size_t STREAM_CHUNK_BYTES = 1 << 20;
+
+// Mapeamento de teclas para trilhas (0 a 4)
+int map_key_to_track(int keycode) {
+    switch (keycode) {
+        case ALLEGRO_KEY_A: return 0;
+        case ALLEGRO_KEY_S: return 1;
+        case ALLEGRO_KEY_D: return 2;
+        case ALLEGRO_KEY_F: return 3;
+        case ALLEGRO_KEY_G: return 4;
+        default: return -1;
+    }
+}
+
+// Os charts aceitam duas convenções para a tecla de cada nota:
+// o código ASCII da letra (97 = 'a', 115 = 's', ...) ou o ALLEGRO_KEY_* correspondente.
+int chart_code_to_track(int code) {
+    switch (code) {
+        case 'a': case 'A': return 0;
+        case 's': case 'S': return 1;
+        case 'd': case 'D': return 2;
+        case 'f': case 'F': return 3;
+        case 'g': case 'G': return 4;
+        default: return map_key_to_track(code);
+    }
+}
+
+static bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool parseChartText(const char* text, size_t length,
+                    std::vector<float>& times, std::vector<uint8_t>& tracks,
+                    std::vector<ChartDiagnostic>& diagnostics) {
+    const char* p = text;
+    const char* end = text + length;
+    int line = 0;
+    size_t first_error = diagnostics.size();
+
+    while (p < end) {
+        line++;
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!line_end) line_end = end;
+
+        while (p < line_end && isBlank(*p)) p++;
+
+        // Linha vazia ou comentário
+        if (p == line_end || *p == '#') {
+            p = line_end + 1;
+            continue;
+        }
+
+        float time;
+        auto time_result = std::from_chars(p, line_end, time);
+        if (time_result.ec != std::errc()) {
+            diagnostics.push_back({line, "tempo inválido"});
+            p = line_end + 1;
+            continue;
+        }
+        p = time_result.ptr;
+
+        if (p == line_end || !isBlank(*p)) {
+            diagnostics.push_back({line, "esperado código da tecla depois do tempo"});
+            p = line_end + 1;
+            continue;
+        }
+        while (p < line_end && isBlank(*p)) p++;
+
+        int code;
+        auto code_result = std::from_chars(p, line_end, code);
+        if (code_result.ec != std::errc()) {
+            diagnostics.push_back({line, "código da tecla inválido"});
+            p = line_end + 1;
+            continue;
+        }
+        p = code_result.ptr;
+
+        // Só pode sobrar espaço ou um comentário no fim da linha
+        while (p < line_end && isBlank(*p)) p++;
+        if (p < line_end && *p != '#') {
+            diagnostics.push_back({line, "conteúdo inesperado no fim da linha"});
+            p = line_end + 1;
+            continue;
+        }
+
+        int track = chart_code_to_track(code);
+        if (track == -1) {
+            diagnostics.push_back({line, "tecla desconhecida: " + std::to_string(code)});
+        } else if (!std::isfinite(time)) {
+            // from_chars aceita "nan" e "inf"
+            diagnostics.push_back({line, "tempo inválido"});
+        } else if (time < 0) {
+            diagnostics.push_back({line, "tempo negativo"});
+        } else {
+            times.push_back(time);
+            tracks.push_back(static_cast<uint8_t>(track));
+        }
+        p = line_end + 1;
+    }
+
+    return diagnostics.size() == first_error;
+}
+
+// FNV-1a de 32 bits. Para calcular aos poucos, passe o resultado do pedaço anterior em hash
+static uint32_t checksum(const uint8_t* bytes, size_t length, uint32_t hash = 2166136261u) {
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint64_t chartSourceHash(const char* text, size_t length, uint64_t hash) {
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<uint8_t>(text[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static bool isLittleEndian() {
+    const uint16_t probe = 1;
+    uint8_t first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+Chart::Chart() : data(nullptr), size(0) {
+#ifdef _WIN32
+    file_handle = nullptr;
+    mapping_handle = nullptr;
+#endif
+    close();
+}
+
+Chart::~Chart() {
+    close();
+}
+
+void Chart::close() {
+    if (data && owned.empty()) {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        if (mapping_handle) CloseHandle(mapping_handle);
+        if (file_handle) CloseHandle(file_handle);
+        mapping_handle = nullptr;
+        file_handle = nullptr;
+#else
+        munmap(const_cast<uint8_t*>(data), size);
+#endif
+    }
+    owned.clear();
+    data = nullptr;
+    size = 0;
+    note_count = 0;
+    note_times = nullptr;
+    note_tracks = nullptr;
+    for (int t = 0; t < NUM_TRACKS; ++t) {
+        lane_notes[t] = nullptr;
+        lane_size[t] = 0;
+    }
+}
+
+// Confere o cabeçalho e o conteúdo e aponta os blocos para dentro dos bytes
+bool Chart::bind(const uint8_t* bytes, size_t length) {
+    // O arquivo é little-endian e é usado sem conversão
+    if (!isLittleEndian() || length < sizeof(ChartFileHeader)) return false;
+
+    ChartFileHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (header.magic != GHC_MAGIC || header.version != GHC_VERSION) return false;
+    if (header.header_size != sizeof(ChartFileHeader)) return false;
+
+    size_t count = header.note_count;
+    if (length != sizeof(ChartFileHeader) + count * (sizeof(float) + sizeof(uint32_t) + sizeof(uint8_t))) {
+        return false;
+    }
+
+    size_t lane_total = 0;
+    for (int t = 0; t < NUM_TRACKS; ++t) lane_total += header.lane_count[t];
+    if (lane_total != count) return false;
+
+    const float* times = reinterpret_cast<const float*>(bytes + sizeof(ChartFileHeader));
+    const uint32_t* lanes = reinterpret_cast<const uint32_t*>(times + count);
+    const uint8_t* tracks = reinterpret_cast<const uint8_t*>(lanes + count);
+
+    // O NoteManager usa trilhas e filas como índices sem conferir: um arquivo
+    // corrompido (ou editado à mão) é recusado aqui, antes de chegar lá.
+    // Tempos finitos e em ordem crescente; trilhas válidas
+    for (size_t i = 0; i < count; ++i) {
+        if (!std::isfinite(times[i]) || (i > 0 && times[i] < times[i - 1])) return false;
+        if (tracks[i] >= NUM_TRACKS) return false;
+    }
+    // Cada fila só tem notas da própria trilha, em ordem (então cada nota aparece uma vez)
+    const uint32_t* lane = lanes;
+    for (int t = 0; t < NUM_TRACKS; ++t) {
+        for (size_t k = 0; k < header.lane_count[t]; ++k) {
+            if (lane[k] >= count || tracks[lane[k]] != t) return false;
+            if (k > 0 && lane[k] <= lane[k - 1]) return false;
+        }
+        lane += header.lane_count[t];
+    }
+
+    note_count = count;
+    note_times = times;
+    note_tracks = tracks;
+    for (int t = 0; t < NUM_TRACKS; ++t) {
+        lane_notes[t] = lanes;
+        lane_size[t] = header.lane_count[t];
+        lanes += header.lane_count[t];
+    }
+    return true;
+}
+
+bool Chart::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    file_handle = file;
+    mapping_handle = mapping;
+    data = static_cast<const uint8_t*>(view);
+    size = static_cast<size_t>(file_size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // O mapeamento continua válido sem o descritor
+    if (view == MAP_FAILED) return false;
+    data = static_cast<const uint8_t*>(view);
+    size = static_cast<size_t>(info.st_size);
+#endif
+
+    if (!bind(data, size)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool Chart::adopt(std::vector<uint8_t>&& bytes) {
+    close();
+    owned = std::move(bytes);
+    if (owned.empty() || !bind(owned.data(), owned.size())) {
+        owned.clear();
+        return false;
+    }
+    data = owned.data();
+    size = owned.size();
+    return true;
+}
+
+bool Chart::verifyChecksum() const {
+    if (!data) return false;
+    ChartFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    return header.checksum == checksum(data + sizeof(header), size - sizeof(header));
+}
+
+ChartFileHeader Chart::header() const {
+    ChartFileHeader header = {};
+    if (data) std::memcpy(&header, data, sizeof(header));
+    return header;
+}
+
+std::vector<uint8_t> Chart::build(const std::vector<float>& times, const std::vector<uint8_t>& tracks,
+                                  const ChartSource& source) {
+    const size_t count = times.size();
+
+    // Ordena por tempo (estável, para manter a ordem do arquivo em notas simultâneas)
+    std::vector<uint32_t> order(count);
+    for (size_t i = 0; i < count; ++i) order[i] = static_cast<uint32_t>(i);
+    std::stable_sort(order.begin(), order.end(),
+                     [&times](uint32_t a, uint32_t b) { return times[a] < times[b]; });
+
+    ChartFileHeader header = {};
+    header.magic = GHC_MAGIC;
+    header.version = GHC_VERSION;
+    header.header_size = sizeof(ChartFileHeader);
+    header.note_count = static_cast<uint32_t>(count);
+    header.source_hash = source.hash;
+    header.source_size = source.size;
+    header.source_mtime = source.mtime;
+    header.audio_stamp = source.audio_stamp;
+    header.flags = source.flags;
+
+    std::vector<uint8_t> bytes(sizeof(header) + count * (sizeof(float) + sizeof(uint32_t) + sizeof(uint8_t)));
+    float* out_times = reinterpret_cast<float*>(bytes.data() + sizeof(header));
+    uint32_t* out_lanes = reinterpret_cast<uint32_t*>(out_times + count);
+    uint8_t* out_tracks = reinterpret_cast<uint8_t*>(out_lanes + count);
+
+    for (size_t i = 0; i < count; ++i) {
+        out_times[i] = times[order[i]];
+        out_tracks[i] = tracks[order[i]];
+        header.lane_count[out_tracks[i]]++;
+    }
+
+    // Índices agrupados por trilha, cada grupo em ordem de tempo
+    size_t lane_offset[NUM_TRACKS];
+    size_t offset = 0;
+    for (int t = 0; t < NUM_TRACKS; ++t) {
+        lane_offset[t] = offset;
+        offset += header.lane_count[t];
+    }
+    for (size_t i = 0; i < count; ++i) {
+        out_lanes[lane_offset[out_tracks[i]]++] = static_cast<uint32_t>(i);
+    }
+
+    header.checksum = checksum(bytes.data() + sizeof(header), bytes.size() - sizeof(header));
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    return bytes;
+}
+
+bool readChartText(const std::string& path, std::string& text) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    text.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(&text[0], text.size());
+    return file.good() || text.empty();
+}
+
+bool chartSourceStamp(const std::string& path, ChartSource& source) {
+    std::error_code ec;
+    const uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec) return false;
+    const std::filesystem::file_time_type mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) return false;
+    source.size = size;
+    source.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    return true;
+}
+
+// Monta o .ghc a partir do texto já lido
+static std::vector<uint8_t> compileSource(const std::string& path, const std::string& text, ChartSource source) {
+    std::vector<float> times;
+    std::vector<uint8_t> tracks;
+    std::vector<ChartDiagnostic> diagnostics;
+    times.reserve(text.size() / 8);
+    tracks.reserve(text.size() / 8);
+
+    // Linhas com erro são puladas; o resto do chart continua valendo
+    parseChartText(text.data(), text.size(), times, tracks, diagnostics);
+    for (const ChartDiagnostic& diagnostic : diagnostics) {
+        std::cerr << path << ":" << diagnostic.line << ": " << diagnostic.message << std::endl;
+    }
+
+    source.hash = chartSourceHash(text.data(), text.size());
+    return Chart::build(times, tracks, source);
+}
+
+bool Chart::compileText(const std::string& path, std::vector<uint8_t>& bytes) {
+    // Lê o arquivo inteiro de uma vez e faz o parse direto no buffer
+    ChartSource source;
+    std::string text;
+    if (!chartSourceStamp(path, source) || !readChartText(path, text)) return false;
+    bytes = compileSource(path, text, source);
+    return true;
+}
+
+// Troca path pelo arquivo temporário já gravado (ou apaga o temporário, se falhar)
+static bool replaceWithTemp(const std::string& temp_path, const std::string& path) {
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool Chart::write(const std::string& path, const std::vector<uint8_t>& bytes) {
+    const std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        if (!file.good()) {
+            file.close();
+            std::remove(temp_path.c_str());
+            return false;
+        }
+    }
+    return replaceWithTemp(temp_path, path);
+}
+
+static bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// .ghc que fica ao lado de um chart em texto
+static std::string compiledPathFor(const std::string& path) {
+    std::string compiled_path = path;
+    size_t dotPos = compiled_path.rfind('.');
+    if (dotPos != std::string::npos) compiled_path.erase(dotPos);
+    return compiled_path + ".ghc";
+}
+
+// Lê só o cabeçalho de um .ghc (sem mapear nem validar o resto)
+static bool readHeader(const std::string& path, ChartFileHeader& header) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    return header.magic == GHC_MAGIC && header.version == GHC_VERSION &&
+           header.header_size == sizeof(ChartFileHeader);
+}
+
+static bool sameStamp(const ChartFileHeader& header, const ChartSource& source) {
+    return header.source_size == source.size && header.source_mtime == source.mtime;
+}
+
+// O texto mudou de data mas não de conteúdo (cópia, checkout): só atualiza tamanho e
+// data no cabeçalho, para a próxima carga não precisar ler o texto de novo.
+// O checksum não cobre o cabeçalho, então o resto do arquivo continua valendo.
+static void refreshStamp(const std::string& compiled_path, const ChartSource& source) {
+    std::fstream file(compiled_path, std::ios::binary | std::ios::in | std::ios::out);
+    ChartFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return;
+    header.source_size = source.size;
+    header.source_mtime = source.mtime;
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+// Hash do texto lido aos poucos, sem carregar o arquivo inteiro
+static bool hashTextFile(const std::string& path, uint64_t& hash) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    std::vector<char> buffer(STREAM_CHUNK_BYTES);
+    hash = SOURCE_HASH_SEED;
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+        hash = chartSourceHash(buffer.data(), static_cast<size_t>(file.gcount()), hash);
+    }
+    return !file.bad();
+}
+
+// Compila um chart em texto sem carregá-lo inteiro na memória: o texto é lido em
+// pedaços de STREAM_CHUNK_BYTES, os tempos vão direto para o .ghc e as trilhas para
+// um arquivo temporário, que depois é relido uma vez por trilha para montar as filas.
+// Como nada é ordenado, as notas precisam estar em ordem de tempo no texto; um chart
+// fora de ordem precisa passar antes pelo ghchartc, que grava o .ghc já normalizado.
+static bool compileTextStreaming(const std::string& path, const std::string& compiled_path,
+                                 ChartSource source) {
+    std::ifstream text(path, std::ios::binary);
+    if (!text.is_open()) return false;
+
+    const std::string temp_path = compiled_path + ".tmp";
+    const std::string tracks_path = compiled_path + ".tracks.tmp";
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    std::ofstream tracks_out(tracks_path, std::ios::binary | std::ios::trunc);
+    auto fail = [&]() {
+        out.close();
+        tracks_out.close();
+        std::remove(temp_path.c_str());
+        std::remove(tracks_path.c_str());
+        return false;
+    };
+    if (!out.is_open() || !tracks_out.is_open()) return fail();
+
+    // O cabeçalho só fica completo no fim; por enquanto reserva o espaço
+    ChartFileHeader header = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<char> buffer(STREAM_CHUNK_BYTES);
+    std::vector<float> times;
+    std::vector<uint8_t> tracks;
+    std::vector<ChartDiagnostic> diagnostics;
+    size_t pending = 0; // Começo de linha que sobrou do pedaço anterior
+    int line_base = 0;
+    size_t count = 0;
+    float last_time = 0;
+    uint32_t sum = checksum(nullptr, 0);
+    source.hash = SOURCE_HASH_SEED;
+
+    bool at_end = false;
+    while (!at_end) {
+        if (pending == buffer.size()) buffer.resize(buffer.size() * 2); // Linha maior que o pedaço
+        text.read(buffer.data() + pending, buffer.size() - pending);
+        const size_t filled = pending + static_cast<size_t>(text.gcount());
+        if (text.bad()) return fail();
+        at_end = !text;
+
+        // Só faz o parse até a última linha completa; o resto fica para o próximo pedaço
+        size_t length = filled;
+        if (!at_end) {
+            while (length > 0 && buffer[length - 1] != '\n') --length;
+            if (length == 0) {
+                pending = filled;
+                continue;
+            }
+        }
+
+        times.clear();
+        tracks.clear();
+        diagnostics.clear();
+        parseChartText(buffer.data(), length, times, tracks, diagnostics);
+        for (const ChartDiagnostic& diagnostic : diagnostics) {
+            std::cerr << path << ":" << line_base + diagnostic.line << ": " << diagnostic.message << std::endl;
+        }
+        source.hash = chartSourceHash(buffer.data(), length, source.hash);
+        line_base += static_cast<int>(std::count(buffer.data(), buffer.data() + length, '\n'));
+
+        for (size_t i = 0; i < times.size(); ++i) {
+            if (count + i > 0 && times[i] < last_time) {
+                std::cerr << path << ": notas fora de ordem; normalize o chart com o ghchartc" << std::endl;
+                return fail();
+            }
+            last_time = times[i];
+            header.lane_count[tracks[i]]++;
+        }
+        count += times.size();
+        if (count > UINT32_MAX) return fail();
+
+        const char* time_bytes = reinterpret_cast<const char*>(times.data());
+        out.write(time_bytes, times.size() * sizeof(float));
+        sum = checksum(reinterpret_cast<const uint8_t*>(time_bytes), times.size() * sizeof(float), sum);
+        tracks_out.write(reinterpret_cast<const char*>(tracks.data()), tracks.size());
+
+        pending = filled - length;
+        std::memmove(buffer.data(), buffer.data() + length, pending);
+    }
+    tracks_out.close();
+    if (!out || !tracks_out) return fail();
+
+    // Filas por trilha: uma passada pelo arquivo de trilhas para cada trilha
+    std::vector<uint8_t> chunk(STREAM_CHUNK_BYTES);
+    std::vector<uint32_t> lane;
+    for (int t = 0; t < NUM_TRACKS; ++t) {
+        std::ifstream tracks_in(tracks_path, std::ios::binary);
+        uint32_t index = 0;
+        while (tracks_in.read(reinterpret_cast<char*>(chunk.data()), chunk.size()) || tracks_in.gcount() > 0) {
+            const size_t n = static_cast<size_t>(tracks_in.gcount());
+            lane.clear();
+            for (size_t k = 0; k < n; ++k) {
+                if (chunk[k] == t) lane.push_back(index + static_cast<uint32_t>(k));
+            }
+            index += static_cast<uint32_t>(n);
+            const char* lane_bytes = reinterpret_cast<const char*>(lane.data());
+            out.write(lane_bytes, lane.size() * sizeof(uint32_t));
+            sum = checksum(reinterpret_cast<const uint8_t*>(lane_bytes), lane.size() * sizeof(uint32_t), sum);
+        }
+        if (tracks_in.bad()) return fail();
+    }
+
+    // Por último as trilhas, copiadas do arquivo temporário
+    {
+        std::ifstream tracks_in(tracks_path, std::ios::binary);
+        while (tracks_in.read(reinterpret_cast<char*>(chunk.data()), chunk.size()) || tracks_in.gcount() > 0) {
+            const size_t n = static_cast<size_t>(tracks_in.gcount());
+            out.write(reinterpret_cast<const char*>(chunk.data()), n);
+            sum = checksum(chunk.data(), n, sum);
+        }
+        if (tracks_in.bad()) return fail();
+    }
+
+    header.magic = GHC_MAGIC;
+    header.version = GHC_VERSION;
+    header.header_size = sizeof(ChartFileHeader);
+    header.note_count = static_cast<uint32_t>(count);
+    header.checksum = sum;
+    header.source_hash = source.hash;
+    header.source_size = source.size;
+    header.source_mtime = source.mtime;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out) return fail();
+    std::remove(tracks_path.c_str());
+    return replaceWithTemp(temp_path, compiled_path);
+}
+
+bool compileChart(const std::string& path, std::string& compiled_path) {
+    if (endsWith(path, ".ghc")) {
+        compiled_path = path;
+        return true;
+    }
+    compiled_path = compiledPathFor(path);
+
+    ChartSource source;
+    if (!chartSourceStamp(path, source)) return false;
+    ChartFileHeader header;
+    const bool has_header = readHeader(compiled_path, header);
+    if (has_header && sameStamp(header, source)) return true;
+
+    uint64_t hash;
+    if (has_header && hashTextFile(path, hash) && header.source_hash == hash) {
+        refreshStamp(compiled_path, source);
+        return true;
+    }
+    return compileTextStreaming(path, compiled_path, source);
+}
+
+bool loadChart(const std::string& path, Chart& chart) {
+    if (endsWith(path, ".ghc")) return chart.open(path);
+    const std::string compiled_path = compiledPathFor(path);
+
+    // Caminho comum: o .ghc está em dia e é mapeado e validado uma vez só
+    ChartSource source;
+    if (!chartSourceStamp(path, source)) return false;
+    const bool opened = chart.open(compiled_path);
+    if (opened && sameStamp(chart.header(), source)) return true;
+
+    std::string text;
+    if (!readChartText(path, text)) return false;
+    if (opened && chart.header().source_hash == chartSourceHash(text.data(), text.size())) {
+        // Fecha antes de gravar: no Windows o arquivo mapeado não pode ser aberto para escrita
+        chart.close();
+        refreshStamp(compiled_path, source);
+        return chart.open(compiled_path);
+    }
+
+    // Recompila; sem permissão de escrita, usa o chart compilado direto da memória
+    std::vector<uint8_t> bytes = compileSource(path, text, source);
+    if (!Chart::write(compiled_path, bytes)) {
+        std::cerr << "Aviso: não foi possível gravar " << compiled_path << std::endl;
+    }
+    return chart.adopt(std::move(bytes));
+}
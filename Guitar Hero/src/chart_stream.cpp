@@ -0,0 +1,117 @@
+#include "chart_stream.h"
+#include "chart_file.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+// Quantas notas a thread lê do arquivo por vez
+const size_t READ_CHUNK = 512;
+
+ChartStream::ChartStream(size_t ring_capacity, double lookahead_seconds)
+    : ring(ring_capacity), lookahead(lookahead_seconds), playhead(0.0),
+      stop_requested(false), read_failed(false), note_count(0) {}
+
+ChartStream::~ChartStream() {
+    close();
+}
+
+bool ChartStream::open(const std::string& path) {
+    close();
+    if (!compileChart(path, compiled_path)) {
+        compiled_path.clear();
+        return false;
+    }
+    return start();
+}
+
+bool ChartStream::rewind() {
+    close();
+    return !compiled_path.empty() && start();
+}
+
+// Confere o cabeçalho do .ghc e começa a ler as notas na thread
+bool ChartStream::start() {
+    std::ifstream file(compiled_path, std::ios::binary);
+    ChartFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (header.magic != GHC_MAGIC || header.version != GHC_VERSION ||
+        header.header_size != sizeof(ChartFileHeader)) {
+        return false;
+    }
+
+    // Mesma organização do Chart: tempos, filas por trilha e depois as trilhas
+    const size_t times_offset = sizeof(ChartFileHeader);
+    const size_t tracks_offset = times_offset + header.note_count * (sizeof(float) + sizeof(uint32_t));
+
+    // Arquivo truncado (ou com lixo no fim) não bate com o número de notas do cabeçalho
+    file.seekg(0, std::ios::end);
+    if (!file || static_cast<size_t>(file.tellg()) != tracks_offset + header.note_count) {
+        std::cerr << "Chart com tamanho inconsistente: " << compiled_path << std::endl;
+        return false;
+    }
+
+    note_count = header.note_count;
+    playhead.store(0.0);
+    stop_requested.store(false);
+    read_failed.store(false);
+    reader = std::thread(&ChartStream::readLoop, this, compiled_path, times_offset, tracks_offset);
+    return true;
+}
+
+void ChartStream::close() {
+    stop_requested.store(true);
+    if (reader.joinable()) reader.join();
+    ring.clear();
+    note_count = 0;
+}
+
+void ChartStream::setPlayhead(double song_position) {
+    playhead.store(song_position, std::memory_order_relaxed);
+}
+
+void ChartStream::readLoop(std::string compiled_path, size_t times_offset, size_t tracks_offset) {
+    // Dois leitores: um no bloco de tempos e outro no bloco de trilhas
+    std::ifstream times_file(compiled_path, std::ios::binary);
+    std::ifstream tracks_file(compiled_path, std::ios::binary);
+    times_file.seekg(times_offset);
+    tracks_file.seekg(tracks_offset);
+
+    float times[READ_CHUNK];
+    uint8_t tracks[READ_CHUNK];
+    size_t next = 0;
+    float last_time = -std::numeric_limits<float>::infinity();
+
+    while (next < note_count && !stop_requested.load()) {
+        const size_t count = std::min(READ_CHUNK, note_count - next);
+        times_file.read(reinterpret_cast<char*>(times), count * sizeof(float));
+        tracks_file.read(reinterpret_cast<char*>(tracks), count);
+        // Um .ghc aberto direto não passa pelo Chart::bind: cada nota é conferida aqui.
+        // Trilha fora do intervalo indexaria as filas do NoteManager fora dos limites,
+        // e a janela circular depende dos tempos finitos e em ordem.
+        bool bad_note = false;
+        for (size_t i = 0; i < count; ++i) {
+            if (!std::isfinite(times[i]) || times[i] < last_time || tracks[i] >= NUM_TRACKS) bad_note = true;
+            last_time = times[i];
+        }
+        if (!times_file || !tracks_file || bad_note) {
+            std::cerr << "Erro ao ler o chart: " << compiled_path << std::endl;
+            read_failed.store(true);
+            return;
+        }
+
+        for (size_t i = 0; i < count && !stop_requested.load(); ) {
+            // Só entrega notas dentro da janela de leitura antecipada, e só se couberem
+            double horizon = playhead.load(std::memory_order_relaxed) + lookahead;
+            if (times[i] > horizon || !ring.push({times[i], tracks[i]})) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                continue;
+            }
+            ++i;
+        }
+        next += count;
+    }
+}
@@ -1,5 +1,6 @@
 #include "file_handler.h"
 #include <fstream>
+#include <sys/stat.h>
 // Para listar arquivos, precisaríamos de uma biblioteca ou código específico do SO.
 // No Linux, poderíamos usar <dirent.h>. Vamos deixar um placeholder por enquanto.
 // #include <dirent.h>
@@ -13,6 +14,41 @@ bool FileHandler::saveScore(const std::string& filename, int score) {
     return true;
 }
 
+std::map<std::string, std::string> FileHandler::loadSettings(const std::string& filename) {
+    std::map<std::string, std::string> settings;
+    std::ifstream file(filename);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) continue;
+        settings[line.substr(0, equals)] = line.substr(equals + 1);
+    }
+    return settings;
+}
+
+bool FileHandler::saveSettings(const std::string& filename, const std::map<std::string, std::string>& values) {
+    std::map<std::string, std::string> settings = loadSettings(filename);
+    for (const auto& value : values) {
+        settings[value.first] = value.second;
+    }
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    for (const auto& setting : settings) {
+        file << setting.first << "=" << setting.second << std::endl;
+    }
+    return true;
+}
+
+long long FileHandler::fileSize(const std::string& path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return -1;
+    return static_cast<long long>(info.st_size);
+}
+
 std::vector<std::string> FileHandler::listFiles(const std::string& directoryPath) {
     std::vector<std::string> files;
     
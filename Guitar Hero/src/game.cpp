@@ -1,24 +1,115 @@
 #include "game.h"
 #include "file_handler.h"
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <allegro5/allegro_primitives.h>
 #include <allegro5/allegro_ttf.h>
 #include <allegro5/allegro_audio.h>
 #include <allegro5/allegro_acodec.h>
 
+// Maior cache de charts aceito nas configurações, em MB
+const double MAX_CHART_CACHE_MB = 64 * 1024;
+
+// Fração do intervalo entre frames que o loop pode gastar processando eventos
+// antes de desenhar; o que sobrar na fila fica para o próximo frame
+const double EVENT_BUDGET_FRACTION = 0.25;
+
+// Charts maiores que isso são lidos aos poucos durante a música (memória limitada)
+const long long STREAMING_MIN_BYTES = 16 * 1024 * 1024;
+const double STREAMING_LOOKAHEAD_SECONDS = 10.0;
+
+bool setTimingOption(TimingSettings& timing, const std::string& key, const std::string& value) {
+    char* end = nullptr;
+    const double number = std::strtod(value.c_str(), &end);
+    // strtod também aceita "nan" e "inf", que não servem para nenhuma opção
+    const bool is_number = !value.empty() && *end == '\0' && std::isfinite(number);
+
+    if (key == "tick_rate" && is_number && number > 0) {
+        timing.tick_rate = number;
+    } else if (key == "frame_rate" && value == "vsync") {
+        timing.vsync = true;
+    } else if (key == "frame_rate" && value == "uncapped") {
+        timing.frame_rate = 0;
+        timing.vsync = false;
+    } else if (key == "frame_rate" && is_number && number >= 0) {
+        timing.frame_rate = number;
+        timing.vsync = false;
+    } else if (key == "max_catch_up_ticks" && is_number && number >= 1) {
+        timing.max_catch_up_ticks = static_cast<int>(number);
+    } else if (key == "audio_offset_ms" && is_number) {
+        timing.audio_offset = number / 1000.0;
+    } else if (key == "video_offset_ms" && is_number) {
+        timing.video_offset = number / 1000.0;
+    } else if (key == "chart_cache_mb" && is_number && number >= 0 && number <= MAX_CHART_CACHE_MB) {
+        timing.chart_cache_bytes = static_cast<size_t>(number * 1024 * 1024);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void LoopStats::addJitterSample(double jitter, double present) {
+    jitter_samples++;
+    jitter_sum += jitter;
+    if (jitter > max_jitter) max_jitter = jitter;
+    present_sum += present;
+    jitter_squares += jitter * jitter;
+    present_squares += present * present;
+    jitter_present += jitter * present;
+}
+
+// Correlação de Pearson entre o jitter e a duração do present (0 = independentes)
+double LoopStats::jitterPresentCorrelation() const {
+    if (jitter_samples < 2) return 0.0;
+    const double n = static_cast<double>(jitter_samples);
+    const double covariance = n * jitter_present - jitter_sum * present_sum;
+    const double jitter_variance = n * jitter_squares - jitter_sum * jitter_sum;
+    const double present_variance = n * present_squares - present_sum * present_sum;
+    if (jitter_variance <= 0 || present_variance <= 0) return 0.0;
+    return covariance / std::sqrt(jitter_variance * present_variance);
+}
+
+// Limite de partículas dos efeitos de acerto/erro (um acorde de 5 notas usa ~90)
+const size_t MAX_EFFECT_PARTICLES = 512;
+
+// Quantos textos renderizados o cache guarda (menus inteiros + alguns placares)
+const size_t TEXT_CACHE_ENTRIES = 128;
+
+// Texto formatado como no printf, para desenhar pelo cache de textos
+static std::string formatText(const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    return buffer;
+}
+
+static ALLEGRO_COLOR backgroundColor() {
+    return al_map_rgb(20, 20, 40);
+}
+
 // Construtor
-Game::Game() : 
-    running(false), currentState(GameState::MENU), display(nullptr), 
-    event_queue(nullptr), timer(nullptr), font(nullptr), 
+Game::Game(const TimingSettings& timing) : 
+    running(false), currentState(GameState::MENU), screen_dirty(true), display(nullptr), 
+    event_queue(nullptr), timer(nullptr), timing(timing), font(nullptr), text_cache(TEXT_CACHE_ENTRIES), display_changes(0), display_resizes(0), 
     hit_sound(nullptr), miss_sound(nullptr), music_stream(nullptr),
-    score(0), final_score(0), song_position(0.0f), 
+    chartCache(timing.chart_cache_bytes), effects(MAX_EFFECT_PARTICLES),
+    score(0), final_score(0), hud_score(-1), song_position(0.0f), previous_song_position(0.0f), song_position_timestamp(0.0), sim_time(0.0),
     selectedSongIndex(0), menu_option(0), score_screen_option(0), music_started(false) {}
 
 // Destrutor
 Game::~Game() {
+    render_thread.stop();
+    input.stop();
     if (music_stream) al_destroy_audio_stream(music_stream);
     if (hit_sound) al_destroy_sample(hit_sound);
     if (miss_sound) al_destroy_sample(miss_sound);
+    text_cache.clear();
+    renderer.reset();
     if (font) al_destroy_font(font);
     if (timer) al_destroy_timer(timer);
     if (event_queue) al_destroy_event_queue(event_queue);
@@ -29,7 +120,7 @@ Game::~Game() {
 bool Game::initialize() {
     if (!al_init()) return false;
     if (!al_install_keyboard()) return false;
-    if (!al_install_mouse()) return false;
+    // O mouse não é instalado: o jogo não usa, e cada movimento acordaria as telas paradas
     if (!al_init_primitives_addon()) return false;
     al_init_font_addon();
     if (!al_init_ttf_addon()) return false;
@@ -37,11 +128,27 @@ bool Game::initialize() {
     
     al_reserve_samples(10);
 
+    if (timing.vsync) {
+        al_set_new_display_option(ALLEGRO_VSYNC, 1, ALLEGRO_SUGGEST);
+    }
+    // Sem redesenho contínuo nos menus, a janela precisa avisar quando for descoberta
+    al_set_new_display_flags(al_get_new_display_flags() | ALLEGRO_GENERATE_EXPOSE_EVENTS);
     display = al_create_display(800, 600);
-    timer = al_create_timer(1.0 / 60.0);
+    if (display) renderer.reset(new DisplayRenderBackend(display));
+    // Sem timer, o loop roda o mais rápido possível. Com vsync quem espera o monitor é
+    // a thread de desenho, então a simulação publica frames na taxa do monitor.
+    double frame_rate = timing.frame_rate;
+    if (timing.vsync) {
+        frame_rate = display ? al_get_display_refresh_rate(display) : 0;
+        if (frame_rate <= 0) frame_rate = 60.0;
+    }
+    if (frame_rate > 0) {
+        timer = al_create_timer(1.0 / frame_rate);
+        if (!timer) return false;
+    }
     event_queue = al_create_event_queue();
 
-    if (!display || !timer || !event_queue) return false;
+    if (!display || !event_queue) return false;
     
     font = al_load_ttf_font("assets/fonts/font.ttf", 32, 0); 
     if (!font) {
@@ -51,48 +158,201 @@ bool Game::initialize() {
     hit_sound = al_load_sample("assets/sounds/hit.wav");
     miss_sound = al_load_sample("assets/sounds/miss.wav");
 
+    warmText();
+    // A parte fixa da tela de jogo (pista, colunas, zona de acerto e alvos) é gravada
+    // uma vez só; o backend a guarda num bitmap
+    playfield.clearTo(backgroundColor());
+    drawPlayfield(playfield);
+    renderer->setTextCache(&text_cache);
+    renderer->setLayer(&playfield);
+
     al_register_event_source(event_queue, al_get_display_event_source(display));
-    al_register_event_source(event_queue, al_get_keyboard_event_source());
-    al_register_event_source(event_queue, al_get_mouse_event_source());
-    al_register_event_source(event_queue, al_get_timer_event_source(timer));
+    // O teclado é lido numa thread própria; se ela não puder ser criada, usa a fila principal
+    if (input.start()) {
+        al_register_event_source(event_queue, input.wakeSource());
+    } else {
+        al_register_event_source(event_queue, al_get_keyboard_event_source());
+    }
+    if (timer) al_register_event_source(event_queue, al_get_timer_event_source(timer));
 
+    // Daqui em diante só a thread de desenho usa o display; sem ela, desenha nesta mesma
+    if (!render_thread.start(renderer.get())) {
+        std::cerr << "Aviso: thread de desenho não iniciada, desenhando no loop principal" << std::endl;
+    }
     return true;
 }
 
 // Run (Loop principal)
+// A simulação avança em ticks fixos de 1/tick_rate segundos, quantos couberem no
+// tempo real que passou desde o último frame; o que sobra (menos de um tick) vira
+// a fração usada para interpolar o desenho. Cada tick tem o seu próprio instante
+// simulado (sim_time), mesmo quando vários rodam em seguida no mesmo frame.
+// Cada frame tem um prazo para processar eventos: mesmo com a fila cheia (teclas
+// repetidas, timer atrasado) o frame é desenhado na hora.
+// Nas telas paradas (menus, placar) o timer é desligado e o loop dorme até chegar
+// algum evento; só então a tela é redesenhada.
 void Game::run() {
     running = true;
-    al_start_timer(timer);
-    bool redraw = true;
+    const double tick = 1.0 / timing.tick_rate;
+    const double frame_interval = timer ? al_get_timer_speed(timer) : tick;
+    const double event_budget = EVENT_BUDGET_FRACTION * frame_interval;
+    if (timer) al_start_timer(timer);
+    double previous_time = al_get_time();
+    double accumulator = 0.0;
+    sim_time = previous_time;
+    bool frame_due = true;
+    double previous_frame_time = previous_time;
+    double previous_interval = 0.0;
 
     while (running) {
         ALLEGRO_EVENT event;
-        al_wait_for_event(event_queue, &event);
+        if (!isAnimated() && !screen_dirty) {
+            if (timer) al_stop_timer(timer);
+            loop_stats.idle_waits++;
+            al_wait_for_event(event_queue, &event);
+            loop_stats.wakeups++;
+            dispatchEvent(event, frame_due);
+            if (!screen_dirty) continue;
+
+            // O tempo parado não conta para a simulação; um tick só, para tratar o input.
+            // O primeiro tick cai no instante de agora (ex.: logo depois de startPlaying).
+            previous_time = al_get_time();
+            accumulator = tick;
+            sim_time = previous_time - accumulator;
+            frame_due = true;
+            previous_interval = 0.0; // A espera não é jitter
 
-        if (event.type == ALLEGRO_EVENT_TIMER) {
-            update(1.0 / 60.0);
-            redraw = true;
-        } else {
-             processEvent(event);
         }
+        if (timer && !al_get_timer_started(timer)) al_start_timer(timer);
+
+        // Com timer, espera a hora do frame processando o que chegar antes
+        while (timer && running && !frame_due) {
+            al_wait_for_event(event_queue, &event);
+            loop_stats.wakeups++;
+            dispatchEvent(event, frame_due);
+        }
+        if (!running) break;
+        if (!timer) loop_stats.wakeups++;
+
+        const double deadline = al_get_time() + event_budget;
+        while (al_get_next_event(event_queue, &event)) {
+            dispatchEvent(event, frame_due);
+            if (al_get_time() >= deadline) {
+                loop_stats.deadline_frames++;
+                break;
+            }
+        }
+        frame_due = false;
+
+        double now = al_get_time();
+        accumulator += now - previous_time;
+        previous_time = now;
+
+        int ticks = 0;
+        while (accumulator >= tick && ticks < timing.max_catch_up_ticks) {
+            sim_time += tick;
+            update(static_cast<float>(tick));
+            accumulator -= tick;
+            ticks++;
+        }
+        // Atraso maior do que o limite de recuperação (ex.: janela arrastada):
+        // descarta o resto em vez de rodar uma rajada de ticks no próximo frame
+        if (accumulator >= tick) {
+            long long dropped = static_cast<long long>(accumulator / tick);
+            loop_stats.skipped_ticks += dropped;
+            accumulator -= dropped * tick;
+            sim_time += dropped * tick;
+        }
+
+        render(static_cast<float>(accumulator / tick));
+        render_thread.publish(frame, display_changes, display_resizes);
+        loop_stats.frames++;
 
-        if (redraw && al_is_event_queue_empty(event_queue)) {
-            redraw = false;
-            render();
-            al_flip_display();
+        // Jitter da simulação: variação do intervalo entre frames consecutivos
+        const double frame_time = al_get_time();
+        const double interval = frame_time - previous_frame_time;
+        if (previous_interval > 0 && isAnimated()) {
+            loop_stats.addJitterSample(std::fabs(interval - previous_interval), render_thread.lastPresentSeconds());
         }
+        previous_interval = interval;
+        previous_frame_time = frame_time;
+        screen_dirty = false;
     }
+
+    std::cout << "Loop: " << loop_stats.frames << " frames, " << loop_stats.events << " eventos, "
+              << loop_stats.dropped_frames << " frames atrasados juntados, "
+              << loop_stats.deadline_frames << " prazos estourados, "
+              << loop_stats.skipped_ticks << " ticks descartados; descartados: "
+              << loop_stats.coalesced_repeats
+              << " repetições de tecla, " << input.droppedCount() << " com a fila de input cheia; "
+              << loop_stats.wakeups << " despertares, " << loop_stats.idle_waits << " esperas ociosas"
+              << std::endl;
+    std::cout << "Cache de charts: " << chartCache.hits() << " acerto(s), " << chartCache.misses()
+              << " falta(s); " << chartCache.entryCount() << " chart(s), " << chartCache.usedBytes() / 1024
+              << " KB de " << chartCache.capacity() / 1024 << " KB" << std::endl;
+
+    render_thread.stop();
+    const RenderStats& render_stats = render_thread.stats();
+    std::cout << "Desenho: " << render_stats.published << " snapshots publicados, "
+              << render_stats.presented << " apresentados, "
+              << render_stats.published - render_stats.presented << " descartados; present médio "
+              << (render_stats.presented ? render_stats.present_seconds * 1000 / render_stats.presented : 0.0)
+              << " ms, máximo " << render_stats.max_present_seconds * 1000 << " ms" << std::endl;
+    std::cout << "Jitter da simulação: médio "
+              << (loop_stats.jitter_samples ? loop_stats.jitter_sum * 1000 / loop_stats.jitter_samples : 0.0)
+              << " ms, máximo " << loop_stats.max_jitter * 1000 << " ms; correlação com o present: "
+              << loop_stats.jitterPresentCorrelation() << std::endl;
+}
+
+// Junta os eventos redundantes antes de repassá-los para o jogo
+void Game::dispatchEvent(const ALLEGRO_EVENT& event, bool& frame_due) {
+    switch (event.type) {
+        case ALLEGRO_EVENT_TIMER:
+            // Vários eventos do timer atrasados na fila viram um frame só
+            if (frame_due) loop_stats.dropped_frames++;
+            frame_due = true;
+            return;
+        case ALLEGRO_EVENT_KEY_CHAR:
+            // Só o KEY_DOWN é usado; as repetições da tecla segurada não têm efeito
+            if (event.keyboard.repeat) loop_stats.coalesced_repeats++;
+            return;
+        case INPUT_WAKE_EVENT:
+            // As teclas em si estão na fila da thread de input e são tratadas no próximo tick
+            screen_dirty = true;
+            return;
+    }
+    loop_stats.events++;
+    processEvent(event);
+}
+
+// Telas que mudam sozinhas, sem input, e precisam ser redesenhadas a cada frame
+bool Game::isAnimated() const {
+    return currentState == GameState::PLAYING || currentState == GameState::CALIBRATION;
 }
 
 // ProcessEvent (Delega eventos)
 void Game::processEvent(const ALLEGRO_EVENT& event) {
+    screen_dirty = true;
     if (event.type == ALLEGRO_EVENT_DISPLAY_CLOSE) {
         running = false;
         return;
     }
+    // Quem redesenha os bitmaps (e confirma o resize) é a thread de desenho, ao ver
+    // os contadores mudarem no próximo snapshot
+    if (event.type == ALLEGRO_EVENT_DISPLAY_RESIZE) {
+        display_changes++;
+        display_resizes++;
+        return;
+    }
+    if (event.type == ALLEGRO_EVENT_DISPLAY_FOUND) {
+        display_changes++;
+        return;
+    }
     if (event.type == ALLEGRO_EVENT_KEY_DOWN && event.keyboard.keycode == ALLEGRO_KEY_ESCAPE) {
          // ESC volta para o menu principal, ou sai do jogo se já estiver no menu
-        if (currentState != GameState::MENU) {
+        if (currentState == GameState::CALIBRATION) {
+            currentState = GameState::MENU; // Cancela a calibração sem gravar nada
+        } else if (currentState != GameState::MENU) {
             endPlaying(); // Encerra a música se estiver tocando
             currentState = GameState::MENU;
         } else {
@@ -107,24 +367,50 @@ void Game::processEvent(const ALLEGRO_EVENT& event) {
         case GameState::SONG_SELECT:   updateSongSelect(event); break;
         case GameState::PLAYING:       updatePlaying(event, 0); break;
         case GameState::SCORE_SCREEN:  updateScoreScreen(event); break;
+        case GameState::CALIBRATION:   updateCalibration(event); break;
+    }
+}
+
+// Repassa as teclas recebidas pela thread de input. Durante a música, os toques são
+// julgados direto pelo tempo marcado na chegada; o resto vira um evento normal.
+void Game::drainInput() {
+    InputRecord record;
+    while (input.pop(record)) {
+        if (currentState == GameState::PLAYING && record.type == ALLEGRO_EVENT_KEY_DOWN &&
+            record.keycode != ALLEGRO_KEY_ESCAPE) {
+            judgePress(record.keycode, record.song_time);
+            continue;
+        }
+        ALLEGRO_EVENT event;
+        event.type = record.type;
+        event.keyboard.keycode = record.keycode;
+        event.keyboard.timestamp = record.timestamp;
+        event.keyboard.display = display;
+        processEvent(event);
     }
 }
 
-// Update (Chamado a cada frame)
+// Update (Chamado a cada tick da simulação)
 void Game::update(float delta_time) {
+    drainInput();
     if (currentState == GameState::PLAYING) {
         updatePlaying({}, delta_time);
+    } else if (currentState == GameState::CALIBRATION) {
+        updateCalibration({});
     }
 }
 
 // Render (Chama a renderização do estado atual)
-void Game::render() {
-    al_clear_to_color(al_map_rgb(20, 20, 40)); 
+// alpha: fração (0 a 1) do próximo tick já decorrida, para interpolar o movimento
+void Game::render(float alpha) {
+    frame.clear();
+    frame.clearTo(backgroundColor());
     switch (currentState) {
         case GameState::MENU:          renderMenu(); break;
         case GameState::SONG_SELECT:   renderSongSelect(); break;
-        case GameState::PLAYING:       renderPlaying(); break;
+        case GameState::PLAYING:       renderPlaying(alpha); break;
         case GameState::SCORE_SCREEN:  renderScoreScreen(); break;
+        case GameState::CALIBRATION:   renderCalibration(); break;
     }
 }
 
@@ -132,12 +418,14 @@ void Game::render() {
 void Game::updateMenu(const ALLEGRO_EVENT& event) {
     if (event.type == ALLEGRO_EVENT_KEY_DOWN) {
         switch (event.keyboard.keycode) {
-            case ALLEGRO_KEY_UP:   menu_option = (menu_option + 1) % 2; break;
-            case ALLEGRO_KEY_DOWN: menu_option = (menu_option + 1) % 2; break;
+            case ALLEGRO_KEY_UP:   menu_option = (menu_option == 0) ? 2 : menu_option - 1; break;
+            case ALLEGRO_KEY_DOWN: menu_option = (menu_option + 1) % 3; break;
             case ALLEGRO_KEY_ENTER:
                 if (menu_option == 0) {
                     loadSongList();
                     currentState = GameState::SONG_SELECT;
+                } else if (menu_option == 1) {
+                    startCalibration();
                 } else { 
                     running = false;
                 }
@@ -146,11 +434,52 @@ void Game::updateMenu(const ALLEGRO_EVENT& event) {
     }
 }
 void Game::renderMenu() {
-    al_draw_text(font, al_map_rgb(255, 255, 255), 400, 100, ALLEGRO_ALIGN_CENTER, "GUITAR HERO CLONE");
+    frame.text(font, al_map_rgb(255, 255, 255), 400, 100, ALLEGRO_ALIGN_CENTER, "GUITAR HERO CLONE");
     ALLEGRO_COLOR play_color = (menu_option == 0) ? al_map_rgb(255, 255, 0) : al_map_rgb(255, 255, 255);
-    ALLEGRO_COLOR exit_color = (menu_option == 1) ? al_map_rgb(255, 255, 0) : al_map_rgb(255, 255, 255);
-    al_draw_text(font, play_color, 400, 250, ALLEGRO_ALIGN_CENTER, "Selecionar Musica");
-    al_draw_text(font, exit_color, 400, 300, ALLEGRO_ALIGN_CENTER, "Sair");
+    ALLEGRO_COLOR calibrate_color = (menu_option == 1) ? al_map_rgb(255, 255, 0) : al_map_rgb(255, 255, 255);
+    ALLEGRO_COLOR exit_color = (menu_option == 2) ? al_map_rgb(255, 255, 0) : al_map_rgb(255, 255, 255);
+    frame.text(font, play_color, 400, 250, ALLEGRO_ALIGN_CENTER, "Selecionar Musica");
+    frame.text(font, calibrate_color, 400, 300, ALLEGRO_ALIGN_CENTER, "Calibrar Latencia");
+    frame.text(font, exit_color, 400, 350, ALLEGRO_ALIGN_CENTER, "Sair");
+}
+
+// Renderiza antes os textos fixos da interface (nas cores em que aparecem), para o
+// primeiro frame de cada tela não travar carregando glifos e criando bitmaps
+void Game::warmText() {
+    const ALLEGRO_COLOR white = al_map_rgb(255, 255, 255);
+    const ALLEGRO_COLOR yellow = al_map_rgb(255, 255, 0);
+    const ALLEGRO_COLOR gray = al_map_rgb(200, 200, 200);
+
+    // Todos os caracteres ASCII imprimíveis: carrega os glifos da fonte de uma vez
+    std::string glyphs;
+    for (char c = ' '; c <= '~'; ++c) glyphs += c;
+    text_cache.warm(font, white, glyphs);
+
+    const char* titles[] = {"GUITAR HERO CLONE", "Selecione uma Musica", "Musica Finalizada!",
+                            "Calibracao de Audio", "Toque qualquer tecla junto com o clique",
+                            "Calibracao de Video", "Toque quando o alvo cruzar a linha",
+                            "Calibracao Concluida!", "Score: 0"};
+    for (const char* title : titles) text_cache.warm(font, white, title);
+
+    // Opções de menu aparecem em branco ou em amarelo (selecionada)
+    const char* options[] = {"Selecionar Musica", "Calibrar Latencia", "Sair", "Jogar Novamente",
+                             "Selecionar Outra Musica", "Voltar ao Menu Principal"};
+    for (const char* option : options) {
+        text_cache.warm(font, white, option);
+        text_cache.warm(font, yellow, option);
+    }
+
+    // O placar final é amarelo (os algarismos brancos já vieram com os glifos acima)
+    text_cache.warm(font, yellow, "Pontuacao Final: 0123456789");
+
+    text_cache.warm(font, gray, "Pressione ENTER para voltar");
+    text_cache.warm(font, gray, "Pressione ENTER para jogar ou ESC para voltar");
+    text_cache.warm(font, al_map_rgb(255, 0, 0), "Nenhuma musica encontrada!");
+
+    for (int tier = 0; tier < NUM_JUDGEMENT_TIERS; ++tier) {
+        const JudgementTier judgement = static_cast<JudgementTier>(tier);
+        text_cache.warm(font, ParticleSystem::judgementColor(judgement), ParticleSystem::judgementText(judgement));
+    }
 }
 
 // --- LÓGICA DA SELEÇÃO DE MÚSICA ---
@@ -184,11 +513,11 @@ void Game::updateSongSelect(const ALLEGRO_EVENT& event) {
 
 // CORREÇÃO 1: Limpeza dos nomes das músicas
 void Game::renderSongSelect() {
-    al_draw_text(font, al_map_rgb(255, 255, 255), 400, 50, ALLEGRO_ALIGN_CENTER, "Selecione uma Musica");
+    frame.text(font, al_map_rgb(255, 255, 255), 400, 50, ALLEGRO_ALIGN_CENTER, "Selecione uma Musica");
 
     if (songList.empty()) {
-        al_draw_text(font, al_map_rgb(255, 0, 0), 400, 250, ALLEGRO_ALIGN_CENTER, "Nenhuma musica encontrada!");
-        al_draw_text(font, al_map_rgb(200,200,200), 400, 550, ALLEGRO_ALIGN_CENTER, "Pressione ENTER para voltar");
+        frame.text(font, al_map_rgb(255, 0, 0), 400, 250, ALLEGRO_ALIGN_CENTER, "Nenhuma musica encontrada!");
+        frame.text(font, al_map_rgb(200,200,200), 400, 550, ALLEGRO_ALIGN_CENTER, "Pressione ENTER para voltar");
         return;
     }
     
@@ -202,31 +531,53 @@ void Game::renderSongSelect() {
         size_t last_dot = filename.find_last_of(".");
         std::string songName = (last_dot == std::string::npos) ? filename : filename.substr(0, last_dot);
 
-        al_draw_text(font, color, 400, 200 + i * 40, ALLEGRO_ALIGN_CENTER, songName.c_str());
+        frame.text(font, color, 400, 200 + i * 40, ALLEGRO_ALIGN_CENTER, songName);
     }
     
-    al_draw_text(font, al_map_rgb(200,200,200), 400, 550, ALLEGRO_ALIGN_CENTER, "Pressione ENTER para jogar ou ESC para voltar");
+    frame.text(font, al_map_rgb(200,200,200), 400, 550, ALLEGRO_ALIGN_CENTER, "Pressione ENTER para jogar ou ESC para voltar");
 }
 
 // --- LÓGICA DO JOGO ---
 void Game::startPlaying() {
     score = 0;
     song_position = 0;
+    previous_song_position = 0;
     music_started = false;
-    noteManager.reset();
-    noteManager.loadSong(selectedSongPath);
+    // Se o chart do cache for o mesmo já ligado ao NoteManager (ex.: "Jogar Novamente"),
+    // só o estado da partida é zerado
+    if (FileHandler::fileSize(selectedSongPath) > STREAMING_MIN_BYTES) {
+        noteManager.streamSong(selectedSongPath, STREAMING_LOOKAHEAD_SECONDS);
+    } else {
+        noteManager.setChart(chartCache.load(selectedSongPath));
+    }
+    if (!noteManager.isSongLoaded()) {
+        std::cerr << "Erro ao abrir o arquivo da música: " << selectedSongPath << std::endl;
+    }
     
     std::string audioPath = selectedSongPath;
     size_t dotPos = audioPath.rfind('.');
     if (dotPos != std::string::npos) audioPath.replace(dotPos, std::string::npos, ".ogg");
 
-    music_stream = al_load_audio_stream(audioPath.c_str(), 4, 2048);
-    if (music_stream) {
-        al_attach_audio_stream_to_mixer(music_stream, al_get_default_mixer());
+    // Mesma música da partida anterior: volta o stream para o começo em vez de recriar
+    if (music_stream && music_stream_path == audioPath && al_rewind_audio_stream(music_stream)) {
         al_set_audio_stream_playing(music_stream, true);
         music_started = true;
-    } 
+    } else {
+        destroyMusicStream();
+        music_stream = al_load_audio_stream(audioPath.c_str(), 4, 2048);
+        if (music_stream) {
+            music_stream_path = audioPath;
+            al_attach_audio_stream_to_mixer(music_stream, al_get_default_mixer());
+            al_set_audio_stream_playing(music_stream, true);
+            music_started = true;
+        } 
+    }
 
+    // A música começa agora, depois de carregar o chart e o áudio. startPlaying só roda
+    // a partir de uma tela parada, e o loop recomeça o tempo simulado logo depois
+    song_position_timestamp = al_get_time();
+    song_clock.start(0.0, song_position_timestamp);
+    input.publishSongClock(song_position - timing.audio_offset, song_position_timestamp);
     currentState = GameState::PLAYING;
 }
 
@@ -240,6 +591,9 @@ void Game::updatePlaying(const ALLEGRO_EVENT& event, float delta_time) {
     } else if (!music_started && noteManager.isSongFinished()) {
         // Se nunca teve música e todas as notas acabaram, o jogo termina.
         song_has_ended = true;
+    } else if (noteManager.hasStreamFailed() && noteManager.isSongFinished()) {
+        // A leitura do chart falhou: não vêm mais notas, então não espera a música acabar.
+        song_has_ended = true;
     }
 
     if(song_has_ended) {
@@ -249,68 +603,139 @@ void Game::updatePlaying(const ALLEGRO_EVENT& event, float delta_time) {
 
     // --- Lógica de Avanço de Tempo ---
     if (delta_time > 0) {
-        // Se a música está tocando, use o tempo dela para a sincronia perfeita.
-        if (music_started && music_stream) {
-            song_position = al_get_audio_stream_position_secs(music_stream);
+        previous_song_position = song_position;
+        // Instante simulado deste tick, não o relógio: numa rajada de ticks cada um
+        // avança a música um tick (e as notas perdidas são vistas tick a tick)
+        const double now = sim_time;
+        // Se a música está tocando, o relógio acompanha a posição dela (suavizada,
+        // já que o stream só informa a posição em saltos de um fragmento)
+        if (music_started && music_stream && al_get_time() - now > delta_time) {
+            // Tick atrasado de uma rajada: a leitura do áudio é de agora, não deste
+            // instante, então só extrapola o relógio
+            song_position = static_cast<float>(song_clock.timeAt(now));
+        } else if (music_started && music_stream) {
+            song_position = static_cast<float>(
+                song_clock.update(al_get_audio_stream_position_secs(music_stream), now));
         } else {
             // Se não, avance o tempo manualmente (RESERVA DE SEGURANÇA)
             song_position += delta_time;
         }
-        
+        song_position_timestamp = now;
+        input.publishSongClock(song_position - timing.audio_offset, song_position_timestamp);
+
         // Atualiza o gerenciador de notas com o tempo correto
-        noteManager.update(song_position, delta_time);
+        noteManager.update(song_position - static_cast<float>(timing.audio_offset));
+        const uint8_t missed_tracks = noteManager.missedTracks();
+        if (missed_tracks) {
+            for (int track = 0; track < NUM_TRACKS; ++track) {
+                if (missed_tracks & (1 << track)) effects.miss(track);
+            }
+            if (miss_sound) {
+                al_play_sample(miss_sound, 1.0, 0.0, 1.0, ALLEGRO_PLAYMODE_ONCE, nullptr);
+            }
+        }
+        effects.update(delta_time);
     }
     
     // --- Lógica de Input ---
     if (event.type == ALLEGRO_EVENT_KEY_DOWN) {
-        int points = noteManager.checkHit(event.keyboard.keycode);
-        if (points > 0) { 
-            score += points;
-            if (hit_sound) {
-                al_play_sample(hit_sound, 1.0, 0.0, 1.0, ALLEGRO_PLAYMODE_ONCE, nullptr);
-            }
+        // Julga pelo instante em que a tecla foi pressionada, não pelo frame atual
+        judgePress(event.keyboard.keycode, toSongTime(event.keyboard.timestamp));
+    }
+}
+
+void Game::judgePress(int key_code, double press_time) {
+    Judgement judgement;
+    if (noteManager.checkHit(key_code, press_time, judgement)) {
+        score += judgementPoints(judgement.tier);
+        effects.hit(judgement.track, judgement.tier);
+        if (hit_sound) {
+            al_play_sample(hit_sound, 1.0, 0.0, 1.0, ALLEGRO_PLAYMODE_ONCE, nullptr);
         }
     }
 }
 
+// Converte um timestamp da Allegro (mesma base de al_get_time) para o tempo da música,
+// descontando a latência de áudio medida na calibração (o jogador toca com o que ouve)
+double Game::toSongTime(double timestamp) const {
+    return song_position + (timestamp - song_position_timestamp) - timing.audio_offset;
+}
+
 // CORREÇÃO 2: Renderização das pistas visuais
-void Game::renderPlaying() {
+// A parte fixa (pista, colunas, zona de acerto e alvos) é a camada do playfield,
+// que o backend guarda num bitmap; a cada frame só as notas e o placar vão por cima.
+void Game::renderPlaying(float alpha) {
+    frame.layer();
+
+    // As notas são desenhadas adiantadas pela latência de vídeo, para cruzarem a linha
+    // (na tela) junto com o som
+    float render_position = previous_song_position + (song_position - previous_song_position) * alpha;
+    noteManager.render(render_position + static_cast<float>(timing.video_offset - timing.audio_offset), frame);
+    effects.render(frame, font);
+    // O texto do placar só é refeito quando o valor muda
+    if (score != hud_score) {
+        hud_score = score;
+        hud_score_text = "Score: " + std::to_string(score);
+    }
+    frame.text(font, al_map_rgb(255, 255, 255), 10, 10, 0, hud_score_text);
+}
+
+void Game::drawPlayfield(RenderList& list) {
     // Desenha a "estrada" do jogo
-    al_draw_filled_rectangle(190, 0, 610, 600, al_map_rgb(25, 25, 25));
+    list.filledRectangle(190, 0, 610, 600, al_map_rgb(25, 25, 25));
 
     // Desenha as 5 colunas
     for (int i = 0; i < 5; ++i) {
-        al_draw_line(200 + i * 80, 0, 200 + i * 80, 600, al_map_rgb(50, 50, 50), 2);
+        list.line(200 + i * 80, 0, 200 + i * 80, 600, al_map_rgb(50, 50, 50), 2);
     }
-    al_draw_line(598, 0, 598, 600, al_map_rgb(50, 50, 50), 2);
+    list.line(598, 0, 598, 600, al_map_rgb(50, 50, 50), 2);
 
 
     // Desenha a zona de acerto
-    al_draw_line(190, 550, 610, 550, al_map_rgb(255, 255, 0), 3);
+    list.line(190, 550, 610, 550, al_map_rgb(255, 255, 0), 3);
 
     // Desenha os alvos fixos na zona de acerto
     const char* keys[] = {"A", "S", "D", "F", "G"};
     for (int i = 0; i < 5; ++i) {
-        al_draw_filled_circle(240 + i * 80, 525, 30, al_map_rgba(255, 255, 255, 50));
-        al_draw_text(font, al_map_rgb(0,0,0), 240 + i * 80, 510, ALLEGRO_ALIGN_CENTER, keys[i]);
+        list.filledCircle(240 + i * 80, 525, 30, al_map_rgba(255, 255, 255, 50));
+        list.text(font, al_map_rgb(0,0,0), 240 + i * 80, 510, ALLEGRO_ALIGN_CENTER, keys[i]);
     }
-
-    noteManager.render();
-    al_draw_textf(font, al_map_rgb(255, 255, 255), 10, 10, 0, "Score: %d", score);
 }
 
 void Game::endPlaying() {
     if (music_stream) {
-        al_detach_audio_stream(music_stream); // Para de tocar
-        al_destroy_audio_stream(music_stream);
-        music_stream = nullptr;
+        // Para de tocar, mas mantém o stream para um possível "Jogar Novamente"
+        al_set_audio_stream_playing(music_stream, false);
+    }
+    if (music_started && song_clock.stats().samples > 0) {
+        const SongClockStats& clock = song_clock.stats();
+        std::cout << "Relógio da música: erro médio " << clock.mean() * 1000 << " ms, rms "
+                  << clock.rms() * 1000 << " ms, máximo " << clock.max_abs * 1000 << " ms, "
+                  << clock.snaps << " salto(s), velocidade " << song_clock.rate() << std::endl;
     }
+    std::cout << "Efeitos: pico de " << effects.peakCount() << " partículas, média " << effects.averageCount()
+              << ", " << effects.droppedCount() << " descartada(s) pelo limite de " << MAX_EFFECT_PARTICLES
+              << std::endl;
+    effects.clear();
+    // No modo streaming, para a thread de leitura e libera a janela enquanto o jogo está
+    // nos menus. Um chart inteiro continua ligado (ele também está no cache), e assim
+    // "Jogar Novamente" só zera o estado da partida (setChart com o mesmo chart)
+    if (noteManager.isStreaming()) noteManager.reset();
     final_score = score; // Salva a pontuação final
     FileHandler::saveScore("scores.txt", final_score);
     currentState = GameState::SCORE_SCREEN;
     score_screen_option = 0; // Reseta a opção do menu de score
 }
 
+void Game::destroyMusicStream() {
+    if (music_stream) {
+        al_detach_audio_stream(music_stream);
+        al_destroy_audio_stream(music_stream);
+        music_stream = nullptr;
+    }
+    music_stream_path.clear();
+}
+
 // --- LÓGICA DA TELA DE PONTUAÇÃO ---
 // CORREÇÃO 5: Nova tela de score com 3 opções
 void Game::updateScoreScreen(const ALLEGRO_EVENT& event) {
@@ -340,10 +765,86 @@ void Game::renderScoreScreen() {
     ALLEGRO_COLOR color2 = (score_screen_option == 1) ? al_map_rgb(255, 255, 0) : al_map_rgb(255, 255, 255);
     ALLEGRO_COLOR color3 = (score_screen_option == 2) ? al_map_rgb(255, 255, 0) : al_map_rgb(255, 255, 255);
 
-    al_draw_text(font, al_map_rgb(255, 255, 255), 400, 100, ALLEGRO_ALIGN_CENTER, "Musica Finalizada!");
-    al_draw_textf(font, al_map_rgb(255, 255, 0), 400, 150, ALLEGRO_ALIGN_CENTER, "Pontuacao Final: %d", final_score);
+    frame.text(font, al_map_rgb(255, 255, 255), 400, 100, ALLEGRO_ALIGN_CENTER, "Musica Finalizada!");
+    frame.text(font, al_map_rgb(255, 255, 0), 400, 150, ALLEGRO_ALIGN_CENTER, formatText("Pontuacao Final: %d", final_score));
+
+    frame.text(font, color1, 400, 300, ALLEGRO_ALIGN_CENTER, "Jogar Novamente");
+    frame.text(font, color2, 400, 350, ALLEGRO_ALIGN_CENTER, "Selecionar Outra Musica");
+    frame.text(font, color3, 400, 400, ALLEGRO_ALIGN_CENTER, "Voltar ao Menu Principal");
+}
+
+// --- CALIBRAÇÃO DE LATÊNCIA ---
+void Game::startCalibration() {
+    calibration.start(al_get_time());
+    currentState = GameState::CALIBRATION;
+}
+
+void Game::updateCalibration(const ALLEGRO_EVENT& event) {
+    if (event.type == ALLEGRO_EVENT_KEY_DOWN) {
+        if (calibration.phase() == Calibration::Phase::DONE) {
+            if (event.keyboard.keycode == ALLEGRO_KEY_ENTER) currentState = GameState::MENU;
+            return;
+        }
+        calibration.tap(event.keyboard.timestamp);
+
+        if (calibration.phase() == Calibration::Phase::DONE) {
+            timing.audio_offset = calibration.audioOffset();
+            timing.video_offset = calibration.videoOffset();
+            std::map<std::string, std::string> offsets;
+            offsets["audio_offset_ms"] = std::to_string(timing.audio_offset * 1000.0);
+            offsets["video_offset_ms"] = std::to_string(timing.video_offset * 1000.0);
+            if (!FileHandler::saveSettings("settings.txt", offsets)) {
+                std::cerr << "Erro ao gravar a calibração em settings.txt" << std::endl;
+            }
+        }
+        return;
+    }
+
+    // Tick: toca o metrônomo na hora de cada batida
+    if (calibration.updateClick(al_get_time()) && hit_sound) {
+        al_play_sample(hit_sound, 1.0, 0.0, 1.0, ALLEGRO_PLAYMODE_ONCE, nullptr);
+    }
+}
+
+void Game::renderCalibration() {
+    const ALLEGRO_COLOR white = al_map_rgb(255, 255, 255);
+    const ALLEGRO_COLOR yellow = al_map_rgb(255, 255, 0);
+    const int taps_needed = Calibration::MEASURED_TAPS;
+
+    switch (calibration.phase()) {
+        case Calibration::Phase::AUDIO:
+            frame.text(font, white, 400, 100, ALLEGRO_ALIGN_CENTER, "Calibracao de Audio");
+            frame.text(font, white, 400, 250, ALLEGRO_ALIGN_CENTER, "Toque qualquer tecla junto com o clique");
+            frame.text(font, yellow, 400, 300, ALLEGRO_ALIGN_CENTER,
+                            formatText("%d / %d", calibration.measuredTaps(), taps_needed));
+            break;
+
+        case Calibration::Phase::VIDEO: {
+            frame.text(font, white, 400, 100, ALLEGRO_ALIGN_CENTER, "Calibracao de Video");
+            frame.text(font, white, 400, 150, ALLEGRO_ALIGN_CENTER, "Toque quando o alvo cruzar a linha");
+            frame.text(font, yellow, 400, 200, ALLEGRO_ALIGN_CENTER,
+                            formatText("%d / %d", calibration.measuredTaps(), taps_needed));
+
+            // O alvo percorre a distância até a linha em exatamente uma batida
+            const float line_y = 525;
+            const float distance = 250;
+            float progress = static_cast<float>(calibration.timeToNextBeat(al_get_time()) / calibration.beatInterval());
+            frame.line(300, line_y, 500, line_y, yellow, 3);
+            if (progress <= 1.0f) {
+                frame.filledEllipse(400, line_y - progress * distance, 35, 15, al_map_rgb(255, 0, 0));
+            }
+            break;
+        }
 
-    al_draw_text(font, color1, 400, 300, ALLEGRO_ALIGN_CENTER, "Jogar Novamente");
-    al_draw_text(font, color2, 400, 350, ALLEGRO_ALIGN_CENTER, "Selecionar Outra Musica");
-    al_draw_text(font, color3, 400, 400, ALLEGRO_ALIGN_CENTER, "Voltar ao Menu Principal");
-}
\ No newline at end of file
+        case Calibration::Phase::DONE:
+            frame.text(font, white, 400, 100, ALLEGRO_ALIGN_CENTER, "Calibracao Concluida!");
+            frame.text(font, yellow, 400, 250, ALLEGRO_ALIGN_CENTER,
+                            formatText("Audio: %.0f ms (mediana %.0f ms)",
+                                       calibration.audioOffset() * 1000, calibration.audioMedian() * 1000));
+            frame.text(font, yellow, 400, 300, ALLEGRO_ALIGN_CENTER,
+                            formatText("Video: %.0f ms (mediana %.0f ms)",
+                                       calibration.videoOffset() * 1000, calibration.videoMedian() * 1000));
+            frame.text(font, al_map_rgb(200, 200, 200), 400, 550, ALLEGRO_ALIGN_CENTER, "Pressione ENTER para voltar");
+            break;
+    }
+}
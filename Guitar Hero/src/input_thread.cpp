@@ -0,0 +1,84 @@
+#include "input_thread.h"
+
+// Eventos de teclado que cabem na fila entre dois ticks da simulação
+const size_t INPUT_RING_EVENTS = 256;
+
+InputThread::InputThread()
+    : ring(INPUT_RING_EVENTS), queue(nullptr), dropped(0),
+      clock_sequence(0), clock_song_time(0.0), clock_timestamp(0.0) {}
+
+InputThread::~InputThread() {
+    stop();
+}
+
+bool InputThread::start() {
+    stop();
+    queue = al_create_event_queue();
+    if (!queue) return false;
+    al_register_event_source(queue, al_get_keyboard_event_source());
+    al_init_user_event_source(&stop_source);
+    al_register_event_source(queue, &stop_source);
+    al_init_user_event_source(&wake_source);
+
+    worker = std::thread(&InputThread::run, this);
+    return true;
+}
+
+void InputThread::stop() {
+    if (!queue) return;
+    if (worker.joinable()) {
+        ALLEGRO_EVENT event;
+        event.user.type = INPUT_STOP_EVENT;
+        al_emit_user_event(&stop_source, &event, nullptr);
+        worker.join();
+    }
+    al_destroy_user_event_source(&wake_source);
+    al_destroy_user_event_source(&stop_source);
+    al_destroy_event_queue(queue);
+    queue = nullptr;
+    ring.clear();
+}
+
+void InputThread::publishSongClock(double song_time, double timestamp) {
+    clock_sequence.fetch_add(1, std::memory_order_relaxed); // Ímpar: escrevendo
+    std::atomic_thread_fence(std::memory_order_release);
+    clock_song_time.store(song_time, std::memory_order_relaxed);
+    clock_timestamp.store(timestamp, std::memory_order_relaxed);
+    clock_sequence.fetch_add(1, std::memory_order_release);
+}
+
+double InputThread::songTimeAt(double timestamp) const {
+    uint32_t before, after;
+    double song_time, anchor;
+    do {
+        before = clock_sequence.load(std::memory_order_acquire);
+        song_time = clock_song_time.load(std::memory_order_relaxed);
+        anchor = clock_timestamp.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = clock_sequence.load(std::memory_order_relaxed);
+    } while (before != after || (before & 1));
+    return song_time + (timestamp - anchor);
+}
+
+void InputThread::run() {
+    while (true) {
+        ALLEGRO_EVENT event;
+        al_wait_for_event(queue, &event);
+        if (event.type == INPUT_STOP_EVENT) break;
+        if (event.type != ALLEGRO_EVENT_KEY_DOWN && event.type != ALLEGRO_EVENT_KEY_UP) continue;
+
+        InputRecord record;
+        record.timestamp = event.keyboard.timestamp;
+        record.song_time = songTimeAt(event.keyboard.timestamp);
+        record.keycode = static_cast<int16_t>(event.keyboard.keycode);
+        record.type = static_cast<uint8_t>(event.type);
+        if (!ring.push(record)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        ALLEGRO_EVENT wake;
+        wake.user.type = INPUT_WAKE_EVENT;
+        al_emit_user_event(&wake_source, &wake, nullptr);
+    }
+}
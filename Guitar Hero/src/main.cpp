@@ -1,8 +1,43 @@
 #include "game.h"
+#include "file_handler.h"
 #include <iostream>
+#include <string>
 
-int main() {
-    Game game;
+// Opções da linha de comando e o nome da chave equivalente no settings.txt
+static const char* const TIMING_OPTIONS[][2] = {
+    {"--tick-rate", "tick_rate"},
+    {"--fps", "frame_rate"},
+    {"--max-catch-up", "max_catch_up_ticks"},
+    {"--audio-offset", "audio_offset_ms"},
+    {"--video-offset", "video_offset_ms"},
+    {"--chart-cache-mb", "chart_cache_mb"},
+};
+
+int main(int argc, char** argv) {
+    // settings.txt primeiro; a linha de comando tem prioridade sobre ele
+    TimingSettings timing;
+    for (const auto& setting : FileHandler::loadSettings("settings.txt")) {
+        if (!setTimingOption(timing, setting.first, setting.second)) {
+            std::cerr << "Configuração ignorada: " << setting.first << "=" << setting.second << std::endl;
+        }
+    }
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool valid = false;
+        for (const auto& option : TIMING_OPTIONS) {
+            if (arg == option[0] && i + 1 < argc) {
+                valid = setTimingOption(timing, option[1], argv[++i]);
+                break;
+            }
+        }
+        if (!valid) {
+            std::cerr << "Uso: guitar_hero [--tick-rate N] [--fps N|uncapped|vsync] [--max-catch-up N]"
+                      << " [--audio-offset ms] [--video-offset ms] [--chart-cache-mb N]" << std::endl;
+            return -1;
+        }
+    }
+
+    Game game(timing);
     
     if (!game.initialize()) {
         std::cerr << "Falha ao inicializar o jogo." << std::endl;
@@ -13,4 +48,4 @@ int main() {
     game.run();
 
     return 0;
-}
\ No newline at end of file
+}
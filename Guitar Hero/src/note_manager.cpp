@@ -1,6 +1,8 @@
 #include "note_manager.h"
-#include <fstream>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <allegro5/allegro_primitives.h>
 
 // --- Constantes para a Velocidade ---
@@ -8,112 +10,338 @@ const float INITIAL_NOTE_SPEED = 300.0f; // Velocidade inicial em pixels/segundo
 const float MAX_NOTE_SPEED = 700.0f;     // Velocidade máxima
 const float SPEED_INCREASE_RATE = 5.0f;  // Quantos pixels/segundo a velocidade aumenta por segundo
 
-// Mapeamento de teclas para trilhas (0 a 4)
-int map_key_to_track(int keycode) {
-    switch (keycode) {
-        case ALLEGRO_KEY_A: return 0;
-        case ALLEGRO_KEY_S: return 1;
-        case ALLEGRO_KEY_D: return 2;
-        case ALLEGRO_KEY_F: return 3;
-        case ALLEGRO_KEY_G: return 4;
-        default: return -1;
+// --- Constantes do modo streaming ---
+const size_t STREAM_RING_NOTES = 4096;     // Notas na fila entre a thread de leitura e o jogo
+const size_t STREAM_WINDOW_NOTES = 16384;  // Notas guardadas ao mesmo tempo (potência de 2)
+
+// --- Constantes da pista ---
+const float HIT_ZONE_Y = 525.0f;  // Posição Y da zona de acerto
+
+
+// Instante (tempo de música) em que a velocidade chega ao máximo, e a distância percorrida até lá
+const double RAMP_END_TIME = (MAX_NOTE_SPEED - INITIAL_NOTE_SPEED) / SPEED_INCREASE_RATE;
+const double RAMP_END_DISTANCE = INITIAL_NOTE_SPEED * RAMP_END_TIME
+                               + 0.5 * SPEED_INCREASE_RATE * RAMP_END_TIME * RAMP_END_TIME;
+
+// Distância de rolagem (em pixels) percorrida desde o início da música até o tempo t.
+// É a integral da velocidade: começa em INITIAL_NOTE_SPEED, aumenta SPEED_INCREASE_RATE
+// por segundo e para em MAX_NOTE_SPEED.
+static double scrollDistance(double t) {
+    if (t <= 0) return INITIAL_NOTE_SPEED * t;
+    if (t >= RAMP_END_TIME) return RAMP_END_DISTANCE + MAX_NOTE_SPEED * (t - RAMP_END_TIME);
+    return INITIAL_NOTE_SPEED * t + 0.5 * SPEED_INCREASE_RATE * t * t;
+}
+
+// Inversa de scrollDistance: em que tempo a rolagem chega à distância d
+static double scrollTime(double d) {
+    if (d <= 0) return d / INITIAL_NOTE_SPEED;
+    if (d >= RAMP_END_DISTANCE) return RAMP_END_TIME + (d - RAMP_END_DISTANCE) / MAX_NOTE_SPEED;
+    return (std::sqrt(double(INITIAL_NOTE_SPEED) * INITIAL_NOTE_SPEED + 2.0 * SPEED_INCREASE_RATE * d)
+            - INITIAL_NOTE_SPEED) / SPEED_INCREASE_RATE;
+}
+
+// Forma das notas: elipse com raios NOTE_RADIUS_X e NOTE_RADIUS_Y, desenhada como
+// um leque de triângulos a partir do centro
+const float NOTE_RADIUS_X = 35.0f;
+const float NOTE_RADIUS_Y = 15.0f;
+const int ELLIPSE_SEGMENTS = 32;
+const int VERTICES_PER_NOTE = ELLIPSE_SEGMENTS + 1;
+const int INDICES_PER_NOTE = ELLIPSE_SEGMENTS * 3;
+const size_t INITIAL_BATCH_NOTES = 256;
+
+// Contorno da elipse centrada na origem, calculado uma vez só
+struct EllipseTemplate {
+    float x[ELLIPSE_SEGMENTS];
+    float y[ELLIPSE_SEGMENTS];
+
+    EllipseTemplate() {
+        const float TWO_PI = 6.28318530718f;
+        for (int s = 0; s < ELLIPSE_SEGMENTS; ++s) {
+            float angle = TWO_PI * s / ELLIPSE_SEGMENTS;
+            x[s] = NOTE_RADIUS_X * std::cos(angle);
+            y[s] = NOTE_RADIUS_Y * std::sin(angle);
+        }
+    }
+};
+static const EllipseTemplate ellipse_template;
+
+int judgementPoints(JudgementTier tier) {
+    switch (tier) {
+        case JudgementTier::PERFECT: return 100;
+        case JudgementTier::GREAT:   return 70;
+        case JudgementTier::GOOD:    return 40;
+        default:                     return 0;
     }
 }
 
-NoteManager::NoteManager() {
+NoteManager::NoteManager() : missed_tracks(0), batch_capacity(0) {
+    reserveBatch(INITIAL_BATCH_NOTES);
     reset();
 }
 
+void NoteManager::setTimingWindows(const TimingWindows& windows) {
+    timing_windows = windows;
+}
+
 void NoteManager::reset() {
-    notes.clear();
-    note_speed = INITIAL_NOTE_SPEED;
+    chart.reset();
+    stream.reset();
+    stream_path.clear();
+    stream_time = std::vector<float>();
+    stream_track = std::vector<uint8_t>();
+    for (int t = 0; t < NUM_TRACKS; ++t) {
+        stream_lanes[t] = std::vector<uint32_t>();
+    }
+    slot_mask = ~size_t(0);
+    received = 0;
+    note_count = 0;
+    note_time = nullptr;
+    note_track = nullptr;
+    for (int t = 0; t < NUM_TRACKS; ++t) {
+        lane_notes[t] = nullptr;
+        lane_size[t] = 0;
+    }
+    restart();
+}
+
+// Zera só o estado da partida; o chart continua carregado
+void NoteManager::restart() {
+    scroll_position = 0;
+    missed_tracks = 0;
+    if (!stream) {
+        state.reset(note_count);
+        return;
+    }
+
+    // No modo streaming a janela começa vazia e o arquivo é lido de novo do início
+    state.reset(slot_mask + 1);
+    received = 0;
+    for (int t = 0; t < NUM_TRACKS; ++t) {
+        lane_size[t] = 0;
+    }
+    if (!stream->rewind()) {
+        std::cerr << "Erro ao reabrir o arquivo da música: " << stream_path << std::endl;
+    }
+}
+
+void JudgementState::reset(size_t note_count) {
+    notes.resize(note_count);
+    if (note_count > 0) std::memset(notes.data(), 0, note_count);
+    head = 0;
+    tail = 0;
+    active_count = 0;
+    hit_count = 0;
+    missed_count = 0;
+    std::memset(tier_counts, 0, sizeof(tier_counts));
+    std::memset(lane_head, 0, sizeof(lane_head));
 }
 
 void NoteManager::loadSong(const std::string& filename) {
-    reset();
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+    auto loaded = std::make_shared<Chart>();
+    if (!loadChart(filename, *loaded)) {
         std::cerr << "Erro ao abrir o arquivo da música: " << filename << std::endl;
+        reset();
+        return;
+    }
+    setChart(loaded);
+}
+
+void NoteManager::setChart(std::shared_ptr<const Chart> new_chart) {
+    if (new_chart && new_chart == chart) {
+        restart();
         return;
     }
 
-    float time;
-    int key_code; 
-    while (file >> time >> key_code) {
-        Note note;
-        note.time = time;
-        note.track = map_key_to_track(key_code);
-        if (note.track == -1) continue; 
+    reset();
+    if (!new_chart) return;
+    chart = std::move(new_chart);
 
-        note.y_position = 0; // Começa um pouco acima da tela
-        note.active = false;
-        note.hit = false;
-        note.missed = false;
-        notes.push_back(note);
+    // As notas são lidas direto do chart (já em ordem de tempo), sem cópia
+    note_count = chart->noteCount();
+    received = note_count;
+    note_time = chart->times();
+    note_track = chart->tracks();
+    for (int t = 0; t < NUM_TRACKS; ++t) {
+        lane_notes[t] = chart->laneNotes(t);
+        lane_size[t] = chart->laneSize(t);
     }
-    std::cout << "Música carregada com " << notes.size() << " notas." << std::endl;
+    restart();
+
+    std::cout << "Música carregada com " << note_count << " notas." << std::endl;
 }
 
-void NoteManager::update(float song_position, float delta_time) {
-    // Aumenta a velocidade gradualmente
-    if (note_speed < MAX_NOTE_SPEED) {
-        note_speed += SPEED_INCREASE_RATE * delta_time;
+void NoteManager::streamSong(const std::string& filename, double lookahead_seconds) {
+    reset();
+    stream.reset(new ChartStream(STREAM_RING_NOTES, lookahead_seconds));
+    if (!stream->open(filename)) {
+        std::cerr << "Erro ao abrir o arquivo da música: " << filename << std::endl;
+        stream.reset();
+        return;
+    }
+    stream_path = filename;
+    note_count = stream->noteCount();
+
+    // Janela circular de tamanho fixo: a nota de índice i fica na posição i & slot_mask
+    slot_mask = STREAM_WINDOW_NOTES - 1;
+    stream_time.assign(STREAM_WINDOW_NOTES, 0.0f);
+    stream_track.assign(STREAM_WINDOW_NOTES, 0);
+    note_time = stream_time.data();
+    note_track = stream_track.data();
+    for (int t = 0; t < NUM_TRACKS; ++t) {
+        stream_lanes[t].assign(STREAM_WINDOW_NOTES, 0);
+        lane_notes[t] = stream_lanes[t].data();
+        lane_size[t] = 0;
     }
+    state.reset(STREAM_WINDOW_NOTES);
+    received = 0;
 
-    const float HIT_ZONE_Y = 525.0f; // Posição Y da zona de acerto
-    // O tempo que a nota fica na tela agora depende da velocidade atual
-    const float seconds_on_screen = HIT_ZONE_Y / note_speed;
+    std::cout << "Música com " << note_count << " notas (lida aos poucos)." << std::endl;
+}
 
-    for (auto& note : notes) {
-        // Ativa a nota quando for a hora certa
-        if (!note.active && !note.hit && !note.missed && song_position >= note.time - seconds_on_screen) {
-            note.active = true;
-            note.y_position = 0; // Garante que ela comece do topo ao ser ativada
-        }
+// Recebe as notas que a thread de leitura já entregou, enquanto houver espaço na janela.
+// As posições antes de state.head já foram julgadas e são reaproveitadas.
+void NoteManager::receiveStreamedNotes(double song_position) {
+    stream->setPlayhead(song_position);
+
+    StreamedNote note;
+    while (received - state.head <= slot_mask && stream->pop(note)) {
+        const size_t slot = received & slot_mask;
+        stream_time[slot] = note.time;
+        stream_track[slot] = note.track;
+        state.notes[slot] = 0;
+        stream_lanes[note.track][lane_size[note.track] & slot_mask] = static_cast<uint32_t>(received);
+        lane_size[note.track]++;
+        received++;
+    }
+}
+
+void NoteManager::update(float song_position) {
+    if (stream) receiveStreamedNotes(song_position);
 
-        // Move a nota se ela estiver ativa
-        if (note.active && !note.hit) {
-            note.y_position += note_speed * delta_time;
+    // A posição de todas as notas sai direto do tempo da música,
+    // então nada aqui depende de quantos frames já passaram.
+    scroll_position = scrollDistance(song_position);
+
+    // Notas com tempo até enter_time já apareceram no topo da tela (y >= 0)
+    const double enter_time = scrollTime(scroll_position + HIT_ZONE_Y);
+    // Notas com tempo antes de miss_time já passaram da janela de acerto
+    const double miss_time = song_position - timing_windows.good;
+
+    // Ativa as notas que entraram na tela (em ordem de tempo, então basta avançar o tail)
+    while (state.tail < received && timeOf(state.tail) <= enter_time) {
+        // Uma nota pode ter sido acertada antes de aparecer (toque entre dois updates)
+        if (stateOf(state.tail) == 0) {
+            stateOf(state.tail) = NOTE_ACTIVE;
+            state.active_count++;
         }
+        state.tail++;
+    }
 
-        // Verifica se a nota foi perdida
-        if (note.active && !note.hit && !note.missed && note.y_position > HIT_ZONE_Y + 30) { // Uma pequena margem
-            note.missed = true;
-            note.active = false;
+    // As notas perdidas formam um prefixo da janela
+    missed_tracks = 0;
+    for (size_t i = state.head; i < state.tail && timeOf(i) < miss_time; ++i) {
+        if (stateOf(i) & NOTE_ACTIVE) {
+            stateOf(i) = NOTE_MISSED;
+            state.active_count--;
+            state.missed_count++;
+            state.tier_counts[static_cast<int>(JudgementTier::MISS)]++;
+            missed_tracks |= 1 << trackOf(i);
+            advanceLane(trackOf(i));
         }
     }
+
+    advanceHead();
+}
+
+// Posição Y da nota i na tela, com a pista rolada até scroll
+float NoteManager::noteY(size_t i, double scroll) const {
+    return static_cast<float>(HIT_ZONE_Y - (scrollDistance(timeOf(i)) - scroll));
 }
 
+// Pula as notas já finalizadas no início da janela
+void NoteManager::advanceHead() {
+    while (state.head < state.tail && isJudged(state.head)) {
+        state.head++;
+    }
+}
+
+// Pula as notas já julgadas no início da fila da trilha
+void NoteManager::advanceLane(int track) {
+    size_t& h = state.lane_head[track];
+    while (h < lane_size[track] && isJudged(laneNote(track, h))) {
+        h++;
+    }
+}
 
 // Implementação da função de contagem
 int NoteManager::getActiveNotesCount() const {
-    int count = 0;
-    for (const auto& note : notes) {
-        if (note.active) {
-            count++;
-        }
-    }
-    return count;
+    return state.active_count;
 }
 
-int NoteManager::checkHit(int key_code) {
+int NoteManager::getTierCount(JudgementTier tier) const {
+    return state.tier_counts[static_cast<int>(tier)];
+}
+
+bool NoteManager::isJudged(size_t i) const {
+    return (stateOf(i) & (NOTE_HIT | NOTE_MISSED)) != 0;
+}
+
+bool NoteManager::checkHit(int key_code, double press_time, Judgement& judgement) {
     int track = map_key_to_track(key_code);
-    if (track == -1) return 0;
-
-    const float HIT_ZONE_Y_START = 480.0f;
-    const float HIT_ZONE_Y_END = 550.0f;
-
-    for (auto& note : notes) {
-        if (note.active && !note.hit && !note.missed && note.track == track) {
-            if (note.y_position >= HIT_ZONE_Y_START && note.y_position <= HIT_ZONE_Y_END) {
-                note.hit = true;
-                note.active = false;
-                return 100;
-            }
+    if (track == -1) return false;
+
+    // Busca binária pela primeira nota da trilha com tempo >= press_time.
+    // A nota mais próxima ainda não julgada está logo antes ou logo depois dela.
+    const size_t first = state.lane_head[track];
+    const size_t last = lane_size[track];
+    size_t low = first;
+    size_t high = last;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (timeOf(laneNote(track, mid)) < press_time) low = mid + 1;
+        else high = mid;
+    }
+
+    size_t before = low;
+    while (before != first && isJudged(laneNote(track, before - 1))) --before;
+    size_t after = low;
+    while (after != last && isJudged(laneNote(track, after))) ++after;
+
+    // Escolhe a candidata com o menor desvio
+    size_t best = 0;
+    double best_offset = 0;
+    bool found = false;
+    if (before != first) {
+        best = laneNote(track, before - 1);
+        best_offset = press_time - timeOf(best);
+        found = true;
+    }
+    if (after != last) {
+        double offset = press_time - timeOf(laneNote(track, after));
+        if (!found || -offset < best_offset) {
+            best = laneNote(track, after);
+            best_offset = offset;
+            found = true;
         }
     }
-    // RETORNA 0 AO ERRAR (SEM PENALIDADE)
-    return 0;
+
+    // Fora da maior janela não conta (toque sem nota não tem penalidade)
+    double distance = std::fabs(best_offset);
+    if (!found || distance > timing_windows.good) return false;
+
+    if (distance <= timing_windows.perfect)    judgement.tier = JudgementTier::PERFECT;
+    else if (distance <= timing_windows.great) judgement.tier = JudgementTier::GREAT;
+    else                                       judgement.tier = JudgementTier::GOOD;
+    judgement.track = track;
+    judgement.offset = static_cast<float>(best_offset);
+
+    if (stateOf(best) & NOTE_ACTIVE) state.active_count--;
+    stateOf(best) = NOTE_HIT;
+    state.hit_count++;
+    state.tier_counts[static_cast<int>(judgement.tier)]++;
+    advanceLane(track);
+    advanceHead();
+    return true;
 }
 
 ALLEGRO_COLOR NoteManager::keyToColor(int track) {
@@ -127,33 +355,61 @@ ALLEGRO_COLOR NoteManager::keyToColor(int track) {
     }
 }
 
-void NoteManager::render() {
+// Garante espaço para notes notas no lote. Os índices não dependem da posição das
+// notas, então são montados aqui e só mudam quando o lote cresce.
+void NoteManager::reserveBatch(size_t notes) {
+    if (notes <= batch_capacity) return;
+    batch_capacity = std::max(notes, batch_capacity * 2);
+    note_indices.resize(batch_capacity * INDICES_PER_NOTE);
+
+    int* index = note_indices.data();
+    for (size_t k = 0; k < batch_capacity; ++k) {
+        const int center = static_cast<int>(k * VERTICES_PER_NOTE);
+        for (int s = 0; s < ELLIPSE_SEGMENTS; ++s) {
+            *index++ = center;
+            *index++ = center + 1 + s;
+            *index++ = center + 1 + (s + 1) % ELLIPSE_SEGMENTS;
+        }
+    }
+}
+
+void NoteManager::render(float song_position, RenderList& list) {
     const float TRACK_START_X = 200.0f;
     const float TRACK_WIDTH = 80.0f;
+    const double scroll = scrollDistance(song_position);
+
+    if (state.tail == state.head) return;
+    reserveBatch(state.tail - state.head);
+
+    ALLEGRO_COLOR lane_colors[NUM_TRACKS];
+    for (int t = 0; t < NUM_TRACKS; ++t) {
+        lane_colors[t] = keyToColor(t);
+    }
 
-    for (const auto& note : notes) {
-        /*if (note.active && !note.hit) {
-            float x1 = TRACK_START_X + note.track * TRACK_WIDTH + 5; // Adiciona margem
-            float y1 = note.y_position - 10;
-            float x2 = x1 + TRACK_WIDTH - 10; // Adiciona margem
-            float y2 = note.y_position + 10;
-            al_draw_filled_circle(x1 + (TRACK_WIDTH - 10)/2, y1 + 10, 25, keyToColor(note.track));
-        }*/
-       if (note.active && !note.hit) {
-            float center_x = TRACK_START_X + (note.track * TRACK_WIDTH) + (TRACK_WIDTH / 2);
-            float center_y = note.y_position;
-            
-            // Desenha uma elipse vermelha
-            al_draw_filled_ellipse(center_x, center_y, 35, 15, al_map_rgb(255, 0, 0));
+    // Monta os vértices de todas as notas visíveis num lote só da lista
+    ALLEGRO_VERTEX* vertex = list.beginTriangles((state.tail - state.head) * VERTICES_PER_NOTE);
+    size_t batched = 0;
+    for (size_t i = state.head; i < state.tail; ++i) {
+        if (!(stateOf(i) & NOTE_ACTIVE)) continue;
+
+        const int track = trackOf(i);
+        const float center_x = TRACK_START_X + (track * TRACK_WIDTH) + (TRACK_WIDTH / 2);
+        const float center_y = noteY(i, scroll);
+        const ALLEGRO_COLOR color = lane_colors[track];
+
+        *vertex++ = {center_x, center_y, 0, 0, 0, color};
+        for (int s = 0; s < ELLIPSE_SEGMENTS; ++s) {
+            *vertex++ = {center_x + ellipse_template.x[s], center_y + ellipse_template.y[s], 0, 0, 0, color};
         }
+        batched++;
     }
+
+    list.endTriangles(batched * VERTICES_PER_NOTE, note_indices.data(), batched * INDICES_PER_NOTE);
 }
 
 bool NoteManager::isSongFinished() const {
-    for (const auto& note : notes) {
-        if (!note.hit && !note.missed) {
-            return false;
-        }
-    }
-    return !notes.empty(); 
+    const size_t resolved = static_cast<size_t>(state.hit_count + state.missed_count);
+    // Se a leitura falhou, as notas que faltam nunca chegam: termina nas já recebidas
+    if (hasStreamFailed()) return resolved == received;
+    return note_count > 0 && resolved == note_count;
 }
\ No newline at end of file
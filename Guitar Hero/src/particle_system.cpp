@@ -0,0 +1,223 @@
+#include "particle_system.h"
+#include <cmath>
+#include <initializer_list>
+
+// Geometria da pista (a mesma do Game::drawPlayfield)
+const float TRACK_START_X = 200.0f;
+const float TRACK_WIDTH = 80.0f;
+const float HIT_LINE_Y = 550.0f;
+
+const int SPARKS_PER_HIT = 12;
+const int EXTRA_SPARKS_PERFECT = 6;
+const float SPARK_LIFETIME = 0.35f;
+const float SPARK_SPEED = 260.0f;   // Velocidade inicial máxima (pixels/s)
+const float SPARK_GRAVITY = 900.0f;
+const float SPARK_SIZE = 2.5f;      // Metade do lado
+const float FLASH_LIFETIME = 0.15f;
+const float FLASH_HEIGHT = 90.0f;   // Metade da altura, a partir da linha de acerto
+const float POPUP_LIFETIME = 0.5f;
+const float POPUP_RISE = 60.0f;     // Quanto o texto sobe durante a vida (pixels)
+const float POPUP_X = 400.0f;
+const float POPUP_Y = 400.0f;
+
+const size_t PARTICLE_BLOCK = 8;
+const int VERTICES_PER_PARTICLE = 4;
+const int INDICES_PER_PARTICLE = 6;
+
+static float laneCenter(int track) {
+    return TRACK_START_X + track * TRACK_WIDTH + TRACK_WIDTH / 2;
+}
+
+// Tamanho dos vetores: a capacidade arredondada para blocos inteiros
+static size_t paddedSize(size_t max_particles) {
+    return (max_particles + PARTICLE_BLOCK - 1) / PARTICLE_BLOCK * PARTICLE_BLOCK;
+}
+
+// Integra as partículas em blocos de PARTICLE_BLOCK. O tamanho fixo do bloco deixa o
+// compilador vetorizar o laço interno mesmo sem -O3; as posições que sobram no último
+// bloco estão livres (os vetores vão até um bloco inteiro) e não importam.
+static void integrate(size_t n, float delta_time, float* __restrict x, float* __restrict y,
+                      const float* __restrict vx, float* __restrict vy, const float* __restrict ay,
+                      float* __restrict life) {
+    for (size_t base = 0; base < n; base += PARTICLE_BLOCK) {
+        for (size_t i = base; i < base + PARTICLE_BLOCK; ++i) {
+            vy[i] += ay[i] * delta_time;
+            x[i] += vx[i] * delta_time;
+            y[i] += vy[i] * delta_time;
+            life[i] -= delta_time;
+        }
+    }
+}
+
+ParticleSystem::ParticleSystem(size_t max_particles)
+    : capacity(max_particles), count(0), indices(max_particles * INDICES_PER_PARTICLE),
+      popup_tier(JudgementTier::MISS), popup_life(0), rng_state(0x9e3779b9u),
+      peak(0), dropped(0), count_sum(0), samples(0) {
+    // Tudo alocado aqui: spawn e update nunca mexem no tamanho dos vetores
+    const size_t storage = paddedSize(capacity);
+    for (std::vector<float>* array : {&x, &y, &vx, &vy, &ay, &half_w, &half_h, &life, &inv_lifetime, &r, &g, &b}) {
+        array->resize(storage);
+    }
+    for (size_t k = 0; k < capacity; ++k) {
+        const int first = static_cast<int>(k * VERTICES_PER_PARTICLE);
+        int* index = &indices[k * INDICES_PER_PARTICLE];
+        index[0] = first;
+        index[1] = first + 1;
+        index[2] = first + 2;
+        index[3] = first;
+        index[4] = first + 2;
+        index[5] = first + 3;
+    }
+    clear();
+}
+
+void ParticleSystem::clear() {
+    count = 0;
+    popup_life = 0;
+    peak = 0;
+    dropped = 0;
+    count_sum = 0;
+    samples = 0;
+}
+
+const char* ParticleSystem::judgementText(JudgementTier tier) {
+    switch (tier) {
+        case JudgementTier::PERFECT: return "PERFEITO";
+        case JudgementTier::GREAT:   return "OTIMO";
+        case JudgementTier::GOOD:    return "BOM";
+        default:                     return "ERROU";
+    }
+}
+
+ALLEGRO_COLOR ParticleSystem::judgementColor(JudgementTier tier) {
+    switch (tier) {
+        case JudgementTier::PERFECT: return al_map_rgb(255, 255, 120);
+        case JudgementTier::GREAT:   return al_map_rgb(120, 255, 120);
+        case JudgementTier::GOOD:    return al_map_rgb(120, 200, 255);
+        default:                     return al_map_rgb(255, 80, 80);
+    }
+}
+
+float ParticleSystem::random(float low, float high) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return low + (high - low) * (rng_state >> 8) * (1.0f / 16777216.0f);
+}
+
+bool ParticleSystem::spawn(float px, float py, float pvx, float pvy, float pay, float hw, float hh,
+                           float lifetime, ALLEGRO_COLOR color) {
+    if (count == capacity) {
+        dropped++;
+        return false;
+    }
+    const size_t i = count++;
+    x[i] = px;
+    y[i] = py;
+    vx[i] = pvx;
+    vy[i] = pvy;
+    ay[i] = pay;
+    half_w[i] = hw;
+    half_h[i] = hh;
+    life[i] = lifetime;
+    inv_lifetime[i] = 1.0f / lifetime;
+    r[i] = color.r;
+    g[i] = color.g;
+    b[i] = color.b;
+    if (count > peak) peak = count;
+    return true;
+}
+
+// Brilho que cobre a trilha em volta da linha de acerto
+void ParticleSystem::flash(int track, ALLEGRO_COLOR color) {
+    spawn(laneCenter(track), HIT_LINE_Y, 0, 0, 0, TRACK_WIDTH / 2, FLASH_HEIGHT, FLASH_LIFETIME, color);
+}
+
+void ParticleSystem::hit(int track, JudgementTier tier) {
+    if (track < 0 || track >= NUM_TRACKS) return;
+    const ALLEGRO_COLOR lane_color = NoteManager::keyToColor(track);
+    flash(track, al_map_rgba_f(lane_color.r * 0.35f, lane_color.g * 0.35f, lane_color.b * 0.35f, 1.0f));
+
+    const int sparks = SPARKS_PER_HIT + (tier == JudgementTier::PERFECT ? EXTRA_SPARKS_PERFECT : 0);
+    const float center_x = laneCenter(track);
+    for (int s = 0; s < sparks; ++s) {
+        // Leque para cima, a partir da linha de acerto
+        const float angle = random(-2.6f, -0.55f);
+        const float speed = random(0.4f, 1.0f) * SPARK_SPEED;
+        if (!spawn(center_x + random(-20.0f, 20.0f), HIT_LINE_Y, std::cos(angle) * speed, std::sin(angle) * speed,
+                   SPARK_GRAVITY, SPARK_SIZE, SPARK_SIZE, SPARK_LIFETIME * random(0.6f, 1.0f), lane_color)) {
+            break;
+        }
+    }
+    popup_tier = tier;
+    popup_life = POPUP_LIFETIME;
+}
+
+void ParticleSystem::miss(int track) {
+    if (track < 0 || track >= NUM_TRACKS) return;
+    flash(track, al_map_rgba_f(0.4f, 0.05f, 0.05f, 1.0f));
+    popup_tier = JudgementTier::MISS;
+    popup_life = POPUP_LIFETIME;
+}
+
+// Remove as partículas que acabaram, trazendo a última para o lugar (a ordem não importa)
+void ParticleSystem::removeExpired() {
+    for (size_t i = 0; i < count;) {
+        if (life[i] > 0) {
+            ++i;
+            continue;
+        }
+        const size_t last = --count;
+        x[i] = x[last];
+        y[i] = y[last];
+        vx[i] = vx[last];
+        vy[i] = vy[last];
+        ay[i] = ay[last];
+        half_w[i] = half_w[last];
+        half_h[i] = half_h[last];
+        life[i] = life[last];
+        inv_lifetime[i] = inv_lifetime[last];
+        r[i] = r[last];
+        g[i] = g[last];
+        b[i] = b[last];
+    }
+}
+
+void ParticleSystem::update(float delta_time) {
+    // Integração: um laço simples sobre vetores contíguos, sem desvios (o compilador vetoriza)
+    integrate(count, delta_time, x.data(), y.data(), vx.data(), vy.data(), ay.data(), life.data());
+
+    removeExpired();
+
+    if (popup_life > 0) popup_life -= delta_time;
+
+    count_sum += count;
+    samples++;
+}
+
+void ParticleSystem::render(RenderList& list, ALLEGRO_FONT* font) const {
+    if (count > 0) {
+        ALLEGRO_VERTEX* vertex = list.beginTriangles(count * VERTICES_PER_PARTICLE);
+        for (size_t i = 0; i < count; ++i) {
+            // Cores com alfa pré-multiplicado (o blender padrão da Allegro)
+            const float alpha = life[i] * inv_lifetime[i];
+            const ALLEGRO_COLOR color = {r[i] * alpha, g[i] * alpha, b[i] * alpha, alpha};
+            const float left = x[i] - half_w[i];
+            const float right = x[i] + half_w[i];
+            const float top = y[i] - half_h[i];
+            const float bottom = y[i] + half_h[i];
+            *vertex++ = {left, top, 0, 0, 0, color};
+            *vertex++ = {right, top, 0, 0, 0, color};
+            *vertex++ = {right, bottom, 0, 0, 0, color};
+            *vertex++ = {left, bottom, 0, 0, 0, color};
+        }
+        list.endTriangles(count * VERTICES_PER_PARTICLE, indices.data(), count * INDICES_PER_PARTICLE);
+    }
+
+    // O texto não some aos poucos: cada cor vira um bitmap no cache de textos
+    if (popup_life > 0) {
+        const float rise = (1.0f - popup_life / POPUP_LIFETIME) * POPUP_RISE;
+        list.text(font, judgementColor(popup_tier), POPUP_X, POPUP_Y - rise, ALLEGRO_ALIGN_CENTER,
+                  judgementText(popup_tier));
+    }
+}
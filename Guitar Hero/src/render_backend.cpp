@@ -0,0 +1,165 @@
+#include "render_backend.h"
+#include <allegro5/allegro_primitives.h>
+#include <cstring>
+
+RenderBackend::RenderBackend()
+    : text_cache(nullptr), layer_list(nullptr), layer_bitmap(nullptr), layer_dirty(true) {}
+
+RenderBackend::~RenderBackend() {
+    if (layer_bitmap) al_destroy_bitmap(layer_bitmap);
+}
+
+void RenderBackend::setLayer(const RenderList* list) {
+    layer_list = list;
+    layer_dirty = true;
+}
+
+void RenderBackend::displayChanged(bool) {
+    // O conteúdo dos bitmaps de vídeo pode ter se perdido junto com o display
+    layer_dirty = true;
+    if (text_cache) text_cache->clear();
+}
+
+// Desenha a camada fixa a partir do bitmap (refeito se o tamanho do destino mudou)
+void RenderBackend::drawLayer(ALLEGRO_BITMAP* target) {
+    if (!layer_list) return;
+    const int width = al_get_bitmap_width(target);
+    const int height = al_get_bitmap_height(target);
+    if (layer_bitmap && (al_get_bitmap_width(layer_bitmap) != width || al_get_bitmap_height(layer_bitmap) != height)) {
+        al_destroy_bitmap(layer_bitmap);
+        layer_bitmap = nullptr;
+    }
+    if (!layer_bitmap) {
+        const int previous_flags = al_get_new_bitmap_flags();
+        al_set_new_bitmap_flags(bitmapFlags());
+        layer_bitmap = al_create_bitmap(width, height);
+        al_set_new_bitmap_flags(previous_flags);
+        layer_dirty = true;
+    }
+    if (!layer_bitmap) {
+        execute(*layer_list, target); // Sem bitmap, desenha a camada direto
+        return;
+    }
+    if (layer_dirty) {
+        layer_dirty = false;
+        execute(*layer_list, layer_bitmap);
+    }
+    al_draw_bitmap(layer_bitmap, 0, 0, 0);
+}
+
+void RenderBackend::execute(const RenderList& list, ALLEGRO_BITMAP* target) {
+    ALLEGRO_BITMAP* previous_target = al_get_target_bitmap();
+    if (target != previous_target) al_set_target_bitmap(target);
+
+    for (const RenderCommand& command : list.commands()) {
+        switch (command.op) {
+            case RenderOp::CLEAR:
+                al_clear_to_color(command.color);
+                break;
+            case RenderOp::FILLED_RECTANGLE:
+                al_draw_filled_rectangle(command.x1, command.y1, command.x2, command.y2, command.color);
+                break;
+            case RenderOp::LINE:
+                al_draw_line(command.x1, command.y1, command.x2, command.y2, command.color, command.thickness);
+                break;
+            case RenderOp::FILLED_ELLIPSE:
+                al_draw_filled_ellipse(command.x1, command.y1, command.x2, command.y2, command.color);
+                break;
+            case RenderOp::TRIANGLES:
+                al_draw_indexed_prim(list.vertexData() + command.first, nullptr, nullptr,
+                                     list.indexData() + command.first_index,
+                                     static_cast<int>(command.index_count), ALLEGRO_PRIM_TRIANGLE_LIST);
+                break;
+            case RenderOp::TEXT:
+                if (text_cache) {
+                    text_scratch.assign(list.textData() + command.first, command.count);
+                    text_cache->draw(static_cast<ALLEGRO_FONT*>(const_cast<void*>(command.resource)),
+                                     command.color, command.x1, command.y1, command.flags, text_scratch);
+                } else {
+                    al_draw_text(static_cast<const ALLEGRO_FONT*>(command.resource), command.color,
+                                 command.x1, command.y1, command.flags, list.textData() + command.first);
+                }
+                break;
+            case RenderOp::BITMAP:
+                al_draw_bitmap(static_cast<ALLEGRO_BITMAP*>(const_cast<void*>(command.resource)),
+                               command.x1, command.y1, 0);
+                break;
+            case RenderOp::LAYER:
+                if (&list != layer_list) drawLayer(target);
+                break;
+        }
+    }
+
+    if (target != previous_target) al_set_target_bitmap(previous_target);
+}
+
+DisplayRenderBackend::DisplayRenderBackend(ALLEGRO_DISPLAY* display) : display(display) {}
+
+void DisplayRenderBackend::present(const RenderList& list) {
+    execute(list, al_get_backbuffer(display));
+    al_flip_display();
+    frames++;
+}
+
+// O contexto do display fica preso à thread que desenha, sem trocas a cada frame
+void DisplayRenderBackend::bindTarget() {
+    al_set_target_backbuffer(display);
+}
+
+void DisplayRenderBackend::displayChanged(bool resized) {
+    if (resized) al_acknowledge_resize(display);
+    RenderBackend::displayChanged(resized);
+}
+
+int DisplayRenderBackend::bitmapFlags() const {
+    return ALLEGRO_VIDEO_BITMAP;
+}
+
+HeadlessRenderBackend::HeadlessRenderBackend(int width, int height) : frame(nullptr) {
+    const int previous_flags = al_get_new_bitmap_flags();
+    al_set_new_bitmap_flags(ALLEGRO_MEMORY_BITMAP);
+    frame = al_create_bitmap(width, height);
+    al_set_new_bitmap_flags(previous_flags);
+}
+
+HeadlessRenderBackend::~HeadlessRenderBackend() {
+    if (frame) al_destroy_bitmap(frame);
+}
+
+void HeadlessRenderBackend::present(const RenderList& list) {
+    execute(list, frame);
+    frames++;
+}
+
+void HeadlessRenderBackend::bindTarget() {
+    al_set_target_bitmap(frame);
+}
+
+int HeadlessRenderBackend::bitmapFlags() const {
+    return ALLEGRO_MEMORY_BITMAP;
+}
+
+bool HeadlessRenderBackend::capture(std::vector<uint8_t>& rgba) const {
+    const int width = al_get_bitmap_width(frame);
+    const int height = al_get_bitmap_height(frame);
+    ALLEGRO_LOCKED_REGION* region = al_lock_bitmap(frame, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_LOCK_READONLY);
+    if (!region) return false;
+
+    rgba.resize(static_cast<size_t>(width) * height * 4);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = static_cast<const uint8_t*>(region->data) + y * region->pitch;
+        std::memcpy(&rgba[static_cast<size_t>(y) * width * 4], row, static_cast<size_t>(width) * 4);
+    }
+    al_unlock_bitmap(frame);
+    return true;
+}
+
+uint32_t HeadlessRenderBackend::frameHash() const {
+    std::vector<uint8_t> rgba;
+    if (!capture(rgba)) return 0;
+    uint32_t hash = 2166136261u;
+    for (uint8_t byte : rgba) {
+        hash = (hash ^ byte) * 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,105 @@
+#include "render_list.h"
+#include <utility>
+
+void RenderList::clear() {
+    command_list.clear();
+    vertices.clear();
+    indices.clear();
+    characters.clear();
+}
+
+RenderCommand& RenderList::add(RenderOp op, ALLEGRO_COLOR color) {
+    command_list.push_back(RenderCommand());
+    RenderCommand& command = command_list.back();
+    command.op = op;
+    command.flags = 0;
+    command.color = color;
+    command.x1 = command.y1 = command.x2 = command.y2 = 0;
+    command.thickness = 0;
+    command.resource = nullptr;
+    command.first = command.count = command.first_index = command.index_count = 0;
+    return command;
+}
+
+void RenderList::clearTo(ALLEGRO_COLOR color) {
+    add(RenderOp::CLEAR, color);
+}
+
+void RenderList::filledRectangle(float x1, float y1, float x2, float y2, ALLEGRO_COLOR color) {
+    RenderCommand& command = add(RenderOp::FILLED_RECTANGLE, color);
+    command.x1 = x1;
+    command.y1 = y1;
+    command.x2 = x2;
+    command.y2 = y2;
+}
+
+void RenderList::line(float x1, float y1, float x2, float y2, ALLEGRO_COLOR color, float thickness) {
+    RenderCommand& command = add(RenderOp::LINE, color);
+    command.x1 = x1;
+    command.y1 = y1;
+    command.x2 = x2;
+    command.y2 = y2;
+    command.thickness = thickness;
+}
+
+void RenderList::filledCircle(float cx, float cy, float radius, ALLEGRO_COLOR color) {
+    filledEllipse(cx, cy, radius, radius, color);
+}
+
+void RenderList::filledEllipse(float cx, float cy, float rx, float ry, ALLEGRO_COLOR color) {
+    RenderCommand& command = add(RenderOp::FILLED_ELLIPSE, color);
+    command.x1 = cx;
+    command.y1 = cy;
+    command.x2 = rx;
+    command.y2 = ry;
+}
+
+ALLEGRO_VERTEX* RenderList::beginTriangles(size_t max_vertices) {
+    batch_start = vertices.size();
+    vertices.resize(batch_start + max_vertices);
+    return vertices.data() + batch_start;
+}
+
+void RenderList::endTriangles(size_t vertex_count, const int* indices, size_t index_count) {
+    vertices.resize(batch_start + vertex_count);
+    if (index_count == 0) return;
+
+    RenderCommand& command = add(RenderOp::TRIANGLES, al_map_rgb(255, 255, 255));
+    command.first = static_cast<uint32_t>(batch_start);
+    command.count = static_cast<uint32_t>(vertex_count);
+    command.first_index = static_cast<uint32_t>(this->indices.size());
+    command.index_count = static_cast<uint32_t>(index_count);
+    this->indices.insert(this->indices.end(), indices, indices + index_count);
+}
+
+void RenderList::text(ALLEGRO_FONT* font, ALLEGRO_COLOR color, float x, float y, int flags,
+                      const std::string& str) {
+    RenderCommand& command = add(RenderOp::TEXT, color);
+    command.flags = flags;
+    command.x1 = x;
+    command.y1 = y;
+    command.resource = font;
+    command.first = static_cast<uint32_t>(characters.size());
+    command.count = static_cast<uint32_t>(str.size());
+    characters.insert(characters.end(), str.begin(), str.end());
+    characters.push_back('\0');
+}
+
+void RenderList::bitmap(ALLEGRO_BITMAP* bitmap, float x, float y) {
+    RenderCommand& command = add(RenderOp::BITMAP, al_map_rgb(255, 255, 255));
+    command.x1 = x;
+    command.y1 = y;
+    command.resource = bitmap;
+}
+
+void RenderList::layer() {
+    add(RenderOp::LAYER, al_map_rgb(255, 255, 255));
+}
+
+void RenderList::swap(RenderList& other) {
+    command_list.swap(other.command_list);
+    vertices.swap(other.vertices);
+    indices.swap(other.indices);
+    characters.swap(other.characters);
+    std::swap(batch_start, other.batch_start);
+}
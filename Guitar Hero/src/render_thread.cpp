@@ -0,0 +1,95 @@
+#include "render_thread.h"
+
+RenderThread::RenderThread()
+    : backend(nullptr), queue(nullptr), last_present(0.0), seen_changes(0), seen_resizes(0) {}
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+bool RenderThread::start(RenderBackend* new_backend) {
+    stop();
+    backend = new_backend;
+    queue = al_create_event_queue();
+    if (!queue) return false;
+    al_init_user_event_source(&frame_source);
+    al_register_event_source(queue, &frame_source);
+    al_init_user_event_source(&stop_source);
+    al_register_event_source(queue, &stop_source);
+
+    // Solta o contexto nesta thread; a thread de desenho pega o destino em run()
+    al_set_target_bitmap(nullptr);
+    worker = std::thread(&RenderThread::run, this);
+    return true;
+}
+
+void RenderThread::stop() {
+    if (!queue) return;
+    if (worker.joinable()) {
+        ALLEGRO_EVENT event;
+        event.user.type = RENDER_STOP_EVENT;
+        al_emit_user_event(&stop_source, &event, nullptr);
+        worker.join();
+    }
+    al_destroy_user_event_source(&frame_source);
+    al_destroy_user_event_source(&stop_source);
+    al_destroy_event_queue(queue);
+    queue = nullptr;
+    if (backend) backend->bindTarget();
+}
+
+void RenderThread::publish(RenderList& list, uint32_t display_changes, uint32_t display_resizes) {
+    render_stats.published++;
+    FrameSnapshot& snapshot = snapshots.back();
+    snapshot.list.swap(list);
+    snapshot.display_changes = display_changes;
+    snapshot.display_resizes = display_resizes;
+    snapshots.publish();
+
+    if (!worker.joinable()) {
+        // Sem a thread: desenha aqui mesmo
+        if (snapshots.acquire()) present(snapshots.front());
+        return;
+    }
+    ALLEGRO_EVENT event;
+    event.user.type = RENDER_FRAME_EVENT;
+    al_emit_user_event(&frame_source, &event, nullptr);
+}
+
+void RenderThread::present(const FrameSnapshot& snapshot) {
+    if (!backend) return;
+    if (snapshot.display_changes != seen_changes) {
+        const bool resized = snapshot.display_resizes != seen_resizes;
+        seen_changes = snapshot.display_changes;
+        seen_resizes = snapshot.display_resizes;
+        backend->displayChanged(resized);
+    }
+
+    const double start = al_get_time();
+    backend->present(snapshot.list);
+    const double elapsed = al_get_time() - start;
+
+    last_present.store(elapsed, std::memory_order_relaxed);
+    render_stats.presented++;
+    render_stats.present_seconds += elapsed;
+    if (elapsed > render_stats.max_present_seconds) render_stats.max_present_seconds = elapsed;
+}
+
+void RenderThread::run() {
+    if (backend) backend->bindTarget();
+
+    bool stopping = false;
+    while (!stopping) {
+        ALLEGRO_EVENT event;
+        al_wait_for_event(queue, &event);
+        // Vários avisos na fila valem por um: o buffer só guarda o último snapshot
+        do {
+            if (event.type == RENDER_STOP_EVENT) stopping = true;
+        } while (al_get_next_event(queue, &event));
+        if (stopping) break;
+
+        if (snapshots.acquire()) present(snapshots.front());
+    }
+
+    al_set_target_bitmap(nullptr);
+}
@@ -0,0 +1,79 @@
+#include "song_clock.h"
+#include <algorithm>
+#include <cmath>
+
+// Ganhos do PLL: a correção de fase é aplicada como um ajuste de velocidade
+// (constante de tempo de ~2 s) e a parte integral acompanha a deriva do áudio
+const double PHASE_GAIN = 0.5;       // (s/s) por segundo de erro
+const double DRIFT_GAIN = 0.05;      // (s/s) por segundo de erro, por segundo
+const double MAX_RATE_CORRECTION = 0.05;
+// Erros maiores que isso (seek, travada do áudio) não são suavizados: o relógio salta
+const double SNAP_THRESHOLD = 0.25;
+
+double SongClockStats::rms() const {
+    return samples ? std::sqrt(sum_squares / samples) : 0;
+}
+
+SongClock::SongClock() {
+    start(0.0, 0.0);
+}
+
+void SongClock::start(double song_time, double now) {
+    base_time = song_time;
+    base_now = now;
+    rate_ = 1.0;
+    drift = 0.0;
+    last_audio = song_time;
+    last_edge_now = now;
+    last_output = song_time;
+    locked = false;
+    stats_ = SongClockStats();
+}
+
+double SongClock::timeAt(double now) const {
+    return std::max(last_output, base_time + (now - base_now) * rate_);
+}
+
+void SongClock::snap(double audio_position) {
+    // Se o áudio ficou para trás, o tempo devolvido fica parado até ele alcançar
+    base_time = audio_position;
+    rate_ = 1.0;
+    drift = 0.0;
+}
+
+double SongClock::update(double audio_position, double now) {
+    // Muda a base para now, mantendo a velocidade atual
+    base_time += (now - base_now) * rate_;
+    base_now = now;
+    const double error = audio_position - base_time;
+
+    if (audio_position != last_audio) {
+        // A leitura do áudio acabou de mudar: é quando ela está mais próxima do tempo real
+        const double interval = now - last_edge_now;
+        last_audio = audio_position;
+        last_edge_now = now;
+
+        stats_.samples++;
+        stats_.sum += error;
+        stats_.sum_squares += error * error;
+        stats_.max_abs = std::max(stats_.max_abs, std::fabs(error));
+        stats_.last = error;
+
+        if (!locked || std::fabs(error) > SNAP_THRESHOLD) {
+            // Primeira leitura (latência de início do áudio) ou salto grande
+            if (locked) stats_.snaps++;
+            locked = true;
+            snap(audio_position);
+        } else {
+            drift = std::clamp(drift + DRIFT_GAIN * error * interval, -MAX_RATE_CORRECTION, MAX_RATE_CORRECTION);
+            rate_ = 1.0 + std::clamp(drift + PHASE_GAIN * error, -MAX_RATE_CORRECTION, MAX_RATE_CORRECTION);
+        }
+    } else if (-error > SNAP_THRESHOLD) {
+        // O áudio parou de andar (travou ou acabou o buffer): o relógio espera por ele
+        stats_.snaps++;
+        snap(audio_position);
+    }
+
+    last_output = timeAt(now);
+    return last_output;
+}
@@ -0,0 +1,111 @@
+#include "text_cache.h"
+#include <algorithm>
+#include <functional>
+
+static uint32_t packColor(ALLEGRO_COLOR color) {
+    unsigned char r, g, b, a;
+    al_unmap_rgba(color, &r, &g, &b, &a);
+    return (uint32_t(r) << 24) | (uint32_t(g) << 16) | (uint32_t(b) << 8) | a;
+}
+
+size_t TextCache::KeyHash::operator()(const Key& key) const {
+    size_t hash = std::hash<std::string>()(key.text);
+    hash ^= std::hash<const void*>()(key.font) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<uint32_t>()(key.color) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+TextCache::TextCache(size_t max_entries)
+    : max_entries(max_entries), hit_count(0), miss_count(0) {}
+
+TextCache::~TextCache() {
+    clear();
+}
+
+void TextCache::clear() {
+    for (Entry& entry : entries) {
+        if (entry.bitmap) al_destroy_bitmap(entry.bitmap);
+    }
+    entries.clear();
+    index.clear();
+}
+
+const TextCache::Entry& TextCache::lookup(ALLEGRO_FONT* font, ALLEGRO_COLOR color, const std::string& text) {
+    Key key{font, packColor(color), text};
+    auto found = index.find(key);
+    if (found != index.end()) {
+        hit_count++;
+        entries.splice(entries.begin(), entries, found->second); // Vira o mais recente
+        return entries.front();
+    }
+
+    miss_count++;
+    int bbx, bby, bbw, bbh;
+    al_get_text_dimensions(font, text.c_str(), &bbx, &bby, &bbw, &bbh);
+    Entry entry{key, nullptr, bbx, bby, al_get_text_width(font, text.c_str())};
+    if (bbw > 0 && bbh > 0) {
+        entry.bitmap = al_create_bitmap(bbw, bbh);
+    }
+    if (entry.bitmap) {
+        ALLEGRO_BITMAP* previous_target = al_get_target_bitmap();
+        al_set_target_bitmap(entry.bitmap);
+        al_clear_to_color(al_map_rgba(0, 0, 0, 0));
+        al_draw_text(font, color, -bbx, -bby, 0, text.c_str());
+        al_set_target_bitmap(previous_target);
+    }
+
+    entries.push_front(entry);
+    index[key] = entries.begin();
+    if (entries.size() > max_entries) {
+        Entry& oldest = entries.back();
+        if (oldest.bitmap) al_destroy_bitmap(oldest.bitmap);
+        index.erase(oldest.key);
+        entries.pop_back();
+    }
+    return entries.front();
+}
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+int TextCache::split(ALLEGRO_FONT* font, ALLEGRO_COLOR color, const std::string& text) {
+    segments.clear();
+    // Sem algarismos (ou longo demais para caber no cache em pedaços), é um pedaço só
+    if (text.size() >= max_entries || std::none_of(text.begin(), text.end(), isDigit)) {
+        segments.push_back(&lookup(font, color, text));
+        return segments.back()->advance;
+    }
+
+    // O texto não tem mais pedaços do que o cache comporta, então nenhum dos já
+    // procurados é descartado pelos seguintes
+    int width = 0;
+    for (size_t start = 0; start < text.size(); ) {
+        size_t end = start + 1;
+        if (!isDigit(text[start])) {
+            while (end < text.size() && !isDigit(text[end])) ++end;
+        }
+        segments.push_back(&lookup(font, color, text.substr(start, end - start)));
+        width += segments.back()->advance;
+        start = end;
+    }
+    return width;
+}
+
+void TextCache::draw(ALLEGRO_FONT* font, ALLEGRO_COLOR color, float x, float y, int flags,
+                     const std::string& text) {
+    const int width = split(font, color, text);
+    if (flags & ALLEGRO_ALIGN_CENTER) {
+        x -= width / 2.0f;
+    } else if (flags & ALLEGRO_ALIGN_RIGHT) {
+        x -= width;
+    }
+    for (const Entry* entry : segments) {
+        if (entry->bitmap) al_draw_bitmap(entry->bitmap, x + entry->offset_x, y + entry->offset_y, 0);
+        x += entry->advance;
+    }
+}
+
+void TextCache::warm(ALLEGRO_FONT* font, ALLEGRO_COLOR color, const std::string& text) {
+    split(font, color, text);
+}
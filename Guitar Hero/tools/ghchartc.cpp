@@ -0,0 +1,301 @@
+// ghchartc: valida e compila todos os charts de uma pasta de músicas.
+//
+// Uso: ghchartc <pasta de músicas> [-j N] [--force]
+//
+// Para cada chart em texto (.txt) verifica a ordem dos tempos, as teclas,
+// notas duplicadas ou sobrepostas e notas depois do fim do .ogg de mesmo nome.
+// Charts válidos são normalizados e gravados como .ghc ao lado do texto.
+// Charts cujo .ghc o próprio ghchartc já gerou a partir do mesmo texto e do mesmo
+// áudio são pulados; um .ghc compilado pelo jogo é conferido de novo.
+#include "chart_file.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+const float DUPLICATE_GAP = 0.001f; // Notas da mesma trilha mais próximas que isso são a mesma nota
+const float MIN_LANE_GAP = 0.050f;  // Notas da mesma trilha mais próximas que isso se sobrepõem
+
+enum class ChartStatus {
+    COMPILED,
+    UP_TO_DATE,
+    FAILED
+};
+
+struct ChartReport {
+    std::string path;
+    ChartStatus status = ChartStatus::FAILED;
+    size_t notes = 0;
+    std::vector<std::string> errors;
+    std::vector<std::string> warnings;
+};
+
+static uint64_t readLE(const char* bytes, int count) {
+    uint64_t value = 0;
+    for (int i = count - 1; i >= 0; --i) {
+        value = (value << 8) | static_cast<uint8_t>(bytes[i]);
+    }
+    return value;
+}
+
+// Duração de um arquivo Ogg Vorbis em segundos, ou -1 se não der para ler.
+// A taxa de amostragem vem do cabeçalho de identificação do Vorbis (início do arquivo)
+// e o total de amostras é a posição (granule) da última página Ogg (fim do arquivo).
+static double oggDuration(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return -1;
+    const std::streamoff size = file.tellg();
+
+    std::string head(static_cast<size_t>(std::min<std::streamoff>(size, 4096)), '\0');
+    file.seekg(0);
+    file.read(&head[0], head.size());
+
+    // Uma página Ogg tem no máximo 65307 bytes, então a última começa nessa faixa
+    const std::streamoff tail_size = std::min<std::streamoff>(size, 65536 + 4096);
+    std::string tail(static_cast<size_t>(tail_size), '\0');
+    file.seekg(size - tail_size);
+    file.read(&tail[0], tail.size());
+    if (!file) return -1;
+
+    // "\x01vorbis", versão (4 bytes), canais (1 byte), taxa (4 bytes)
+    size_t id = head.find(std::string("\x01vorbis", 7));
+    if (id == std::string::npos || id + 16 > head.size()) return -1;
+    uint64_t rate = readLE(head.data() + id + 12, 4);
+
+    size_t last_page = tail.rfind("OggS");
+    if (last_page == std::string::npos || last_page + 14 > tail.size()) return -1;
+    uint64_t samples = readLE(tail.data() + last_page + 6, 8);
+
+    if (rate == 0) return -1;
+    return static_cast<double>(samples) / rate;
+}
+
+// Identifica o .ogg usado na conferência (0 se não existe): trocar o áudio força
+// conferir o chart de novo, porque a duração pode ter mudado
+static uint64_t audioStamp(const fs::path& path) {
+    ChartSource audio;
+    if (!fs::exists(path) || !chartSourceStamp(path.string(), audio)) return 0;
+    const uint64_t values[2] = {audio.size, static_cast<uint64_t>(audio.mtime)};
+    return chartSourceHash(reinterpret_cast<const char*>(values), sizeof(values));
+}
+
+static ChartReport processChart(const fs::path& chart_path, bool force) {
+    ChartReport report;
+    report.path = chart_path.string();
+
+    std::string text;
+    if (!readChartText(chart_path.string(), text)) {
+        report.errors.push_back("não foi possível ler o arquivo");
+        return report;
+    }
+    const uint64_t hash = chartSourceHash(text.data(), text.size());
+
+    fs::path compiled_path = chart_path;
+    compiled_path.replace_extension(".ghc");
+    fs::path audio_path = chart_path;
+    audio_path.replace_extension(".ogg");
+    const uint64_t audio_stamp = audioStamp(audio_path);
+
+    // Incremental: só confia num .ghc que o ghchartc conferiu, com o mesmo texto e o mesmo áudio.
+    // open() já confere a estrutura do arquivo inteiro, então o checksum não é relido aqui.
+    if (!force) {
+        Chart existing;
+        if (existing.open(compiled_path.string())) {
+            const ChartFileHeader header = existing.header();
+            if ((header.flags & GHC_FLAG_VALIDATED) && header.source_hash == hash &&
+                header.audio_stamp == audio_stamp) {
+                report.status = ChartStatus::UP_TO_DATE;
+                report.notes = existing.noteCount();
+                return report;
+            }
+        }
+    }
+
+    std::vector<float> times;
+    std::vector<uint8_t> tracks;
+    std::vector<ChartDiagnostic> diagnostics;
+    parseChartText(text.data(), text.size(), times, tracks, diagnostics);
+    for (const ChartDiagnostic& diagnostic : diagnostics) {
+        report.errors.push_back("linha " + std::to_string(diagnostic.line) + ": " + diagnostic.message);
+    }
+
+    // Ordem dos tempos no arquivo
+    size_t out_of_order = 0;
+    for (size_t i = 1; i < times.size(); ++i) {
+        if (times[i] < times[i - 1]) out_of_order++;
+    }
+    if (out_of_order > 0) {
+        report.warnings.push_back(std::to_string(out_of_order) + " nota(s) fora de ordem (reordenadas)");
+    }
+
+    // Normaliza: ordena por tempo e remove duplicadas na mesma trilha
+    std::vector<size_t> order(times.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&times](size_t a, size_t b) { return times[a] < times[b]; });
+
+    std::vector<float> normalized_times;
+    std::vector<uint8_t> normalized_tracks;
+    normalized_times.reserve(times.size());
+    normalized_tracks.reserve(times.size());
+
+    float last_time[NUM_TRACKS];
+    bool seen[NUM_TRACKS] = {};
+    size_t duplicates = 0;
+    size_t overlaps = 0;
+    for (size_t i : order) {
+        int track = tracks[i];
+        if (seen[track]) {
+            float gap = times[i] - last_time[track];
+            if (gap < DUPLICATE_GAP) {
+                duplicates++;
+                continue;
+            }
+            if (gap < MIN_LANE_GAP) overlaps++;
+        }
+        seen[track] = true;
+        last_time[track] = times[i];
+        normalized_times.push_back(times[i]);
+        normalized_tracks.push_back(static_cast<uint8_t>(track));
+    }
+    if (duplicates > 0) {
+        report.warnings.push_back(std::to_string(duplicates) + " nota(s) duplicada(s) (removidas)");
+    }
+    if (overlaps > 0) {
+        report.warnings.push_back(std::to_string(overlaps) + " nota(s) a menos de " +
+                                  std::to_string(static_cast<int>(MIN_LANE_GAP * 1000)) +
+                                  " ms da anterior na mesma trilha");
+    }
+
+    // Notas depois do fim da música
+    if (!fs::exists(audio_path)) {
+        report.warnings.push_back("sem áudio (" + audio_path.filename().string() + ")");
+    } else {
+        double duration = oggDuration(audio_path);
+        if (duration < 0) {
+            report.warnings.push_back("não foi possível ler a duração de " + audio_path.filename().string());
+        } else {
+            size_t late = 0;
+            for (float time : normalized_times) {
+                if (time > duration) late++;
+            }
+            if (late > 0) {
+                report.errors.push_back(std::to_string(late) + " nota(s) depois do fim do áudio (" +
+                                        std::to_string(duration) + " s)");
+            }
+        }
+    }
+
+    report.notes = normalized_times.size();
+    if (!report.errors.empty()) return report;
+
+    // Tamanho e data do texto vão junto, para o jogo reconhecer o .ghc sem reler o texto
+    ChartSource source;
+    source.hash = hash;
+    source.audio_stamp = audio_stamp;
+    source.flags = GHC_FLAG_VALIDATED;
+    chartSourceStamp(chart_path.string(), source);
+    std::vector<uint8_t> bytes = Chart::build(normalized_times, normalized_tracks, source);
+    // Chart::write grava num temporário e renomeia, para nunca deixar um .ghc pela metade
+    if (!Chart::write(compiled_path.string(), bytes)) {
+        report.errors.push_back("não foi possível gravar " + compiled_path.string());
+        return report;
+    }
+
+    report.status = ChartStatus::COMPILED;
+    return report;
+}
+
+static void printUsage() {
+    std::cerr << "Uso: ghchartc <pasta de músicas> [-j N] [--force]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string songs_dir;
+    unsigned jobs = std::thread::hardware_concurrency();
+    bool force = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            jobs = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--force") {
+            force = true;
+        } else if (songs_dir.empty() && arg[0] != '-') {
+            songs_dir = arg;
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (songs_dir.empty()) {
+        printUsage();
+        return 2;
+    }
+    if (jobs == 0) jobs = 1;
+
+    std::error_code ec;
+    std::vector<fs::path> charts;
+    for (fs::recursive_directory_iterator it(songs_dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file() && it->path().extension() == ".txt") {
+            charts.push_back(it->path());
+        }
+    }
+    if (ec) {
+        std::cerr << "Erro ao listar " << songs_dir << ": " << ec.message() << std::endl;
+        return 2;
+    }
+    std::sort(charts.begin(), charts.end());
+
+    // Pool de threads: cada worker pega o próximo chart da lista até acabar
+    std::vector<ChartReport> reports(charts.size());
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    jobs = std::min<unsigned>(jobs, std::max<size_t>(charts.size(), 1));
+    for (unsigned w = 0; w < jobs; ++w) {
+        workers.emplace_back([&]() {
+            for (size_t i = next++; i < charts.size(); i = next++) {
+                reports[i] = processChart(charts[i], force);
+            }
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+
+    size_t compiled = 0;
+    size_t up_to_date = 0;
+    size_t failed = 0;
+    for (const ChartReport& report : reports) {
+        switch (report.status) {
+            case ChartStatus::COMPILED:
+                compiled++;
+                std::cout << "compilado   " << report.path << " (" << report.notes << " notas)" << std::endl;
+                break;
+            case ChartStatus::UP_TO_DATE:
+                up_to_date++;
+                break;
+            case ChartStatus::FAILED:
+                failed++;
+                std::cout << "ERRO        " << report.path << std::endl;
+                break;
+        }
+        for (const std::string& warning : report.warnings) {
+            std::cout << "  aviso: " << warning << std::endl;
+        }
+        for (const std::string& error : report.errors) {
+            std::cout << "  erro: " << error << std::endl;
+        }
+    }
+
+    std::cout << charts.size() << " chart(s): " << compiled << " compilado(s), "
+              << up_to_date << " sem mudanças, " << failed << " com erro ("
+              << jobs << " thread(s))" << std::endl;
+    return failed > 0 ? 1 : 0;
+}